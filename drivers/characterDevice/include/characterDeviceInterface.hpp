@@ -3,6 +3,7 @@
 #define EMBEDDED_CLI_FOR_QPCPP_CHARACTERDEVICEINTERFACE_HPP
 
 #include <cstdint>
+#include <cstddef>
 
 namespace cms {
 namespace interfaces {
@@ -14,6 +15,13 @@ namespace interfaces {
 class CharacterDevice {
 public:
     typedef void (*NewByteCallback)(void* userData, uint8_t byte);
+    typedef void (*NewBytesCallback)(void* userData, const uint8_t* bytes, size_t length);
+    typedef void (*WriteReadyCallback)(void* userData);
+
+    enum class FlowControl : uint8_t {
+        STOP,   ///< ask the remote sender to pause
+        GO      ///< allow the remote sender to resume
+    };
 
     /**
      * Write a single byte to the output of this device.
@@ -24,6 +32,30 @@ public:
      */
     virtual bool WriteAsync(uint8_t byte) = 0;
 
+    /**
+     * Write a block of bytes to the output of this device.
+     * Asynchronous. The bytes need only remain valid for the
+     * duration of this call.
+     *
+     * Optional. Devices able to write more than a byte at a time,
+     * such as with DMA or a hardware FIFO, should override this
+     * method. The default writes one byte at a time.
+     *
+     * @param bytes
+     * @param length
+     * @return the number of leading bytes which began writing.
+     *         Less than length upon some error.
+     */
+    virtual size_t WriteAsync(const uint8_t* bytes, size_t length)
+    {
+        size_t written = 0;
+        while ((written < length) && WriteAsync(bytes[written]))
+        {
+            ++written;
+        }
+        return written;
+    }
+
     /**
      * Register a callback to be executed on each new
      * incoming byte received on this device.
@@ -40,6 +72,90 @@ public:
      *                   pointer.
      */
     virtual void RegisterNewByteCallback(NewByteCallback callback, void* userData) = 0;
+
+    /**
+     * Register a callback to be executed on each burst of new
+     * incoming bytes received on this device, such as a completed
+     * DMA transfer or a drained hardware FIFO.
+     *
+     * Optional. Devices which only receive a byte at a time need
+     * not override this method. Users should fall back to
+     * RegisterNewByteCallback() when this method returns false.
+     *
+     * Users should assume this callback is likely executed
+     * from within a separate thread or ISR context. The bytes
+     * are only valid for the duration of the callback.
+     *
+     * @param callback - function ptr of a callback function
+     *                   to be executed for each burst of bytes
+     *                   received.
+     *
+     * @param userData - ptr to something of interest to the
+     *                   user of this object. Typically a 'this'
+     *                   pointer.
+     *
+     * @return true - the callback was registered, and will be used
+     *                instead of any per-byte callback.
+     *         false - this device does not support bulk receive.
+     */
+    virtual bool RegisterNewBytesCallback(NewBytesCallback callback, void* userData)
+    {
+        (void)callback;
+        (void)userData;
+        return false;
+    }
+
+    /**
+     * Apply receive flow control, such as de-asserting RTS on
+     * STOP and asserting RTS on GO.
+     *
+     * Optional. Devices without hardware flow control need not
+     * override this method. Users may fall back to software
+     * flow control (XOFF/XON) when this method returns false.
+     *
+     * STOP may be requested from within the receive callbacks,
+     * i.e. likely from a separate thread or ISR context, and so
+     * must be safe to apply from there.
+     *
+     * @param state - STOP or GO
+     *
+     * @return true - flow control was applied by this device.
+     *         false - this device does not support flow control.
+     */
+    virtual bool SetReceiveFlowControl(FlowControl state)
+    {
+        (void)state;
+        return false;
+    }
+
+    /**
+     * Register a callback to be executed when this device is
+     * again able to accept output, after a WriteAsync() call
+     * wrote fewer bytes than requested. For example, upon a TX
+     * FIFO empty interrupt or a completed DMA transfer.
+     *
+     * Optional. Without it, users can only retry writing
+     * refused output at some later time of their choosing.
+     *
+     * Users should assume this callback is likely executed
+     * from within a separate thread or ISR context.
+     *
+     * @param callback - function ptr of a callback function
+     *                   to be executed when output space frees up.
+     *
+     * @param userData - ptr to something of interest to the
+     *                   user of this object. Typically a 'this'
+     *                   pointer.
+     *
+     * @return true - the callback was registered.
+     *         false - this device does not support this callback.
+     */
+    virtual bool RegisterWriteReadyCallback(WriteReadyCallback callback, void* userData)
+    {
+        (void)callback;
+        (void)userData;
+        return false;
+    }
 };
 
 } // namespace interfaces
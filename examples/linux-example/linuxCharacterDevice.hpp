@@ -13,6 +13,7 @@ class LinuxCharacterDevice : public cms::interfaces::CharacterDevice
 public:
     LinuxCharacterDevice() :
         mCallback(nullptr),
+        mBytesCallback(nullptr),
         mCallbackUserData(nullptr),
         mReader(&LinuxCharacterDevice::Reader, this)
     {
@@ -24,28 +25,55 @@ public:
         return rtn == 1;
     }
 
+    size_t WriteAsync(const uint8_t* bytes, size_t length) override
+    {
+        ssize_t rtn = write(STDOUT_FILENO, bytes, length);
+        return (rtn > 0) ? static_cast<size_t>(rtn) : 0;
+    }
+
     void RegisterNewByteCallback(NewByteCallback callback, void* userData) override
     {
         mCallback = callback;
         mCallbackUserData = userData;
     }
 
+    bool RegisterNewBytesCallback(NewBytesCallback callback, void* userData) override
+    {
+        mBytesCallback = callback;
+        mCallbackUserData = userData;
+        return true;
+    }
+
 private:
     void Reader()
     {
-        char buf;
+        uint8_t buf[64];
         ssize_t result = -1;
         do
         {
-            result = read(STDIN_FILENO, &buf, 1);
-            if (mCallback != nullptr)
+            //a pasted line typically arrives as a single read
+            result = read(STDIN_FILENO, buf, sizeof(buf));
+            if (result <= 0)
+            {
+                break;
+            }
+
+            if (mBytesCallback != nullptr)
+            {
+                mBytesCallback(mCallbackUserData, buf, static_cast<size_t>(result));
+            }
+            else if (mCallback != nullptr)
             {
-                mCallback(mCallbackUserData, buf);
+                for (ssize_t i = 0; i < result; ++i)
+                {
+                    mCallback(mCallbackUserData, buf[i]);
+                }
             }
         }  while (result > 0);
     }
 
     NewByteCallback mCallback = nullptr;
+    NewBytesCallback mBytesCallback = nullptr;
     void* mCallbackUserData = nullptr;
     std::thread mReader = {};
 };
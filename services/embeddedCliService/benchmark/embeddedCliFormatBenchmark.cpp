@@ -0,0 +1,165 @@
+/// @brief  Host benchmark of the Embedded-CLI number formatters vs snprintf
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// License is noted in the service's LICENSE.txt file (MIT)
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "embeddedCliNumberFormat.hpp"
+#include "embedded_cli.h"
+
+using namespace cms::EmbeddedCLI;
+
+namespace {
+
+constexpr size_t HEXDUMP_LENGTH = 4096;
+
+// consumed results, so the compiler cannot drop the formatting
+volatile uint32_t g_sink = 0;
+uint32_t g_outputChars = 0;
+
+void CountChar(EmbeddedCli*, char c)
+{
+    g_outputChars += static_cast<uint8_t>(c);
+}
+
+// deterministic values spread over the full range of each width
+std::vector<uint64_t> MakeValues(size_t count)
+{
+    std::vector<uint64_t> values(count);
+    uint64_t state = 0x9E3779B97F4A7C15u;
+    for (auto& value : values)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        value = state >> (state % 64);
+    }
+    return values;
+}
+
+template <typename Function>
+double NanosecondsPerCall(size_t calls, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < calls; ++i)
+    {
+        function(i);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(calls);
+}
+
+void Report(const char* name, double formatterNs, double snprintfNs)
+{
+    printf("%-26s %10.1f %10.1f %8.2fx\n", name, formatterNs, snprintfNs, snprintfNs / formatterNs);
+}
+
+// the snprintf based hexdump a command handler would otherwise write
+void SnprintfHexDump(EmbeddedCli* cli, const uint8_t* bytes, size_t length, uintptr_t address)
+{
+    for (size_t offset = 0; offset < length; offset += 16)
+    {
+        char line[96];
+        int pos = snprintf(line, sizeof(line), "%08" PRIxPTR " ", address + offset);
+        for (size_t i = 0; i < 16; ++i)
+        {
+            pos += snprintf(&line[pos], sizeof(line) - pos, (i % 8) == 0 ? " %02x " : "%02x ", bytes[offset + i]);
+        }
+        pos += snprintf(&line[pos], sizeof(line) - pos, " |");
+        for (size_t i = 0; i < 16; ++i)
+        {
+            uint8_t b = bytes[offset + i];
+            line[pos++] = ((b >= 0x20) && (b < 0x7F)) ? static_cast<char>(b) : '.';
+        }
+        line[pos++] = '|';
+        line[pos] = '\0';
+        embeddedCliPrint(cli, line);
+    }
+}
+
+} //namespace
+
+int main(int argc, char* argv[])
+{
+    size_t calls = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1000000;
+    if (calls == 0)
+    {
+        fprintf(stderr, "usage: %s [calls]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const auto values = MakeValues(calls);
+    char buffer[FIXED_POINT_BUFFER_SIZE + 8];
+
+    printf("%-26s %10s %10s %9s\n", "ns per call", "formatter", "snprintf", "speedup");
+
+    Report("decimal 32 bit",
+           NanosecondsPerCall(calls, [&](size_t i) { g_sink = g_sink + FormatDecimal(static_cast<uint32_t>(values[i]), buffer); }),
+           NanosecondsPerCall(calls, [&](size_t i) {
+               g_sink = g_sink + snprintf(buffer, sizeof(buffer), "%" PRIu32, static_cast<uint32_t>(values[i]));
+           }));
+
+    Report("decimal 64 bit",
+           NanosecondsPerCall(calls, [&](size_t i) { g_sink = g_sink + FormatDecimal(values[i], buffer); }),
+           NanosecondsPerCall(calls, [&](size_t i) {
+               g_sink = g_sink + snprintf(buffer, sizeof(buffer), "%" PRIu64, values[i]);
+           }));
+
+    Report("hex %08lx",
+           NanosecondsPerCall(calls, [&](size_t i) { g_sink = g_sink + FormatHex(static_cast<uint32_t>(values[i]), 8, buffer); }),
+           NanosecondsPerCall(calls, [&](size_t i) {
+               g_sink = g_sink + snprintf(buffer, sizeof(buffer), "%08" PRIx32, static_cast<uint32_t>(values[i]));
+           }));
+
+    Report("fixed point, 3 digits",
+           NanosecondsPerCall(calls, [&](size_t i) {
+               g_sink = g_sink + FormatFixedPoint(static_cast<int32_t>(values[i]), 3, buffer);
+           }),
+           NanosecondsPerCall(calls, [&](size_t i) {
+               int32_t value = static_cast<int32_t>(values[i]);
+               uint32_t magnitude = (value < 0) ? (0u - static_cast<uint32_t>(value)) : static_cast<uint32_t>(value);
+               g_sink = g_sink + snprintf(buffer, sizeof(buffer), "%s%" PRIu32 ".%03" PRIu32, (value < 0) ? "-" : "",
+                                          magnitude / 1000, magnitude % 1000);
+           }));
+
+    EmbeddedCliConfig* config = embeddedCliDefaultConfig();
+    config->maxBindingCount = 0;
+    EmbeddedCli* cli = embeddedCliNew(config);
+    if (cli == nullptr)
+    {
+        fprintf(stderr, "failed to create the cli\n");
+        return EXIT_FAILURE;
+    }
+    cli->writeChar = CountChar;
+
+    std::vector<uint8_t> memory(HEXDUMP_LENGTH);
+    for (size_t i = 0; i < memory.size(); ++i)
+    {
+        memory[i] = static_cast<uint8_t>(values[i % values.size()]);
+    }
+
+    size_t dumps = (calls / 1000) + 1;
+    Report("hexdump 4 KiB, per byte",
+           NanosecondsPerCall(dumps, [&](size_t) { PrintHexDump(cli, memory.data(), memory.size(), 0x20000000u); }) /
+                   HEXDUMP_LENGTH,
+           NanosecondsPerCall(dumps, [&](size_t) { SnprintfHexDump(cli, memory.data(), memory.size(), 0x20000000u); }) /
+                   HEXDUMP_LENGTH);
+
+    embeddedCliFree(cli);
+    g_sink = g_sink + g_outputChars;
+    return EXIT_SUCCESS;
+}
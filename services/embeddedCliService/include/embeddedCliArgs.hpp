@@ -0,0 +1,426 @@
+/// @brief  The Embedded-CLI Service, typed command arguments
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// License is noted in the service's LICENSE.txt file (MIT)
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+
+#ifndef CMS_EMBEDDED_CLI_ARGS_HPP
+#define CMS_EMBEDDED_CLI_ARGS_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include "embeddedCliCommandBinding.hpp"
+#include "embeddedCliFormat.hpp"
+
+namespace cms {
+namespace EmbeddedCLI {
+
+/**
+ * Describes a single argument of a command, and the field of the
+ * command's argument struct it is parsed into. Not meant to be
+ * filled in by hand, see Positional(), OptionalPositional(),
+ * Option() and Flag() below.
+ */
+struct ArgSpec {
+    enum class Kind : uint8_t {
+        POSITIONAL,
+        OPTIONAL_POSITIONAL,
+        OPTION,   ///< followed by its value, e.g. --count 3
+        FLAG      ///< sets a bool field, e.g. --verify
+    };
+
+    enum class Type : uint8_t {
+        SIGNED,
+        UNSIGNED,
+        FLOAT,
+        BOOL,
+        STRING
+    };
+
+    /// e.g. "address", or for options and flags "--count"
+    const char* name;
+    Kind kind;
+    Type type;
+    uint8_t size;   ///< of the field, in bytes
+
+    /// returns the field within the given argument struct
+    void* (*field)(void* args);
+
+    /// identifies the argument struct, see ParsedCommand()
+    const void* argsType;
+
+    /// integer range, as two's complement for signed fields
+    uint64_t min;
+    uint64_t max;
+};
+
+/**
+ * Parses tokenized command args, as provided to a binding with
+ * tokenizeArgs set, into an argument struct described by specs.
+ * Numbers may be decimal or 0x prefixed hex. Options and flags may
+ * appear anywhere. On bad input a single line describing the problem
+ * is printed and the struct is left partially filled.
+ *
+ * Usually called by a ParsedCommand() binding, rather than directly.
+ *
+ * @param cli - as provided to the command binding
+ * @param specs - the command's schema
+ * @param count - number of specs
+ * @param tokens - tokenized args, may be nullptr when there are none
+ * @param args - the argument struct to fill in
+ * @return true if every token was parsed and all required arguments were given
+ */
+bool ParseArgs(EmbeddedCli* cli, const ArgSpec* specs, size_t count, const char* tokens, void* args);
+
+/**
+ * Tokenizes command args, as embedded-cli does for bindings with
+ * tokenizeArgs set, while filling an index of the tokens in a single
+ * pass. Each token is then accessed directly, rather than by scanning
+ * the tokenized args from the start, as embeddedCliGetToken() does.
+ *
+ * @param args - as provided to a binding with tokenizeArgs cleared,
+ *               may be nullptr when there are none
+ * @param tokens - the index to fill
+ * @param maxTokens - size of the index, only this many tokens are indexed
+ * @return the total number of tokens, greater than maxTokens if some
+ *         were not indexed
+ */
+uint16_t TokenizeArgs(char* args, CommandToken* tokens, uint16_t maxTokens);
+
+namespace detail {
+
+template <typename Member>
+struct MemberTraits;
+
+template <typename Struct, typename Field>
+struct MemberTraits<Field Struct::*> {
+    using StructType = Struct;
+    using FieldType = Field;
+};
+
+template <auto Member>
+using FieldOf = typename MemberTraits<decltype(Member)>::FieldType;
+
+template <auto Member>
+using StructOf = typename MemberTraits<decltype(Member)>::StructType;
+
+template <typename Args>
+struct ArgsTypeTag {
+    static constexpr char id = 0;
+};
+
+template <auto Member>
+void* AccessField(void* args)
+{
+    return &(static_cast<StructOf<Member>*>(args)->*Member);
+}
+
+template <typename Field>
+constexpr ArgSpec::Type TypeOf()
+{
+    static_assert(std::is_integral<Field>::value || std::is_same<Field, float>::value ||
+                  std::is_same<Field, double>::value || std::is_same<Field, const char*>::value,
+                  "argument fields must be integers, bools, floats, doubles or const char*");
+
+    if constexpr (std::is_same<Field, bool>::value)
+    {
+        return ArgSpec::Type::BOOL;
+    }
+    else if constexpr (std::is_floating_point<Field>::value)
+    {
+        return ArgSpec::Type::FLOAT;
+    }
+    else if constexpr (std::is_same<Field, const char*>::value)
+    {
+        return ArgSpec::Type::STRING;
+    }
+    else if constexpr (std::is_signed<Field>::value)
+    {
+        return ArgSpec::Type::SIGNED;
+    }
+    else
+    {
+        return ArgSpec::Type::UNSIGNED;
+    }
+}
+
+template <typename Field>
+constexpr uint64_t RangeBits(Field value)
+{
+    if constexpr (std::is_integral<Field>::value && std::is_signed<Field>::value)
+    {
+        return static_cast<uint64_t>(static_cast<int64_t>(value));
+    }
+    else if constexpr (std::is_integral<Field>::value)
+    {
+        return static_cast<uint64_t>(value);
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+template <auto Member>
+constexpr ArgSpec MakeSpec(const char* name, ArgSpec::Kind kind, uint64_t min, uint64_t max)
+{
+    using Field = FieldOf<Member>;
+    return ArgSpec{name,
+                   kind,
+                   TypeOf<Field>(),
+                   static_cast<uint8_t>(sizeof(Field)),
+                   &AccessField<Member>,
+                   &ArgsTypeTag<StructOf<Member>>::id,
+                   min,
+                   max};
+}
+
+template <auto Member>
+constexpr ArgSpec MakeSpec(const char* name, ArgSpec::Kind kind)
+{
+    using Field = FieldOf<Member>;
+    if constexpr (std::is_integral<Field>::value)
+    {
+        return MakeSpec<Member>(name, kind, RangeBits(std::numeric_limits<Field>::min()),
+                                RangeBits(std::numeric_limits<Field>::max()));
+    }
+    else
+    {
+        return MakeSpec<Member>(name, kind, 0, 0);
+    }
+}
+
+template <typename Handler>
+struct HandlerTraits;
+
+template <typename Args>
+struct HandlerTraits<void (*)(EmbeddedCli*, const Args&, void*)> {
+    using ArgsType = Args;
+};
+
+template <size_t N>
+constexpr bool SchemaIsFor(const ArgSpec (&schema)[N], const void* argsType)
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (schema[i].argsType != argsType)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <size_t N>
+constexpr bool HasValidNames(const ArgSpec (&schema)[N])
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        if ((schema[i].name == nullptr) || (schema[i].name[0] == '\0'))
+        {
+            return false;
+        }
+
+        bool isOption = (schema[i].kind == ArgSpec::Kind::OPTION) || (schema[i].kind == ArgSpec::Kind::FLAG);
+        if (isOption != (schema[i].name[0] == '-'))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <size_t N>
+constexpr bool HasRequiredPositionalsFirst(const ArgSpec (&schema)[N])
+{
+    bool optionalSeen = false;
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (schema[i].kind == ArgSpec::Kind::OPTIONAL_POSITIONAL)
+        {
+            optionalSeen = true;
+        }
+        else if ((schema[i].kind == ArgSpec::Kind::POSITIONAL) && optionalSeen)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+using ArgvHandler = void (*)(EmbeddedCli*, uint16_t, const CommandToken*, void*);
+
+template <auto Handler, uint16_t MaxArgs>
+void TokenizeThenCall(EmbeddedCli* cli, char* args, void* context)
+{
+    CommandToken argv[MaxArgs];
+    uint16_t argc = TokenizeArgs(args, argv, MaxArgs);
+    if (argc > MaxArgs)
+    {
+        PrintFormatted(cli, "Too many arguments: %u, at most %u are accepted", argc, MaxArgs);
+        return;
+    }
+    Handler(cli, argc, argv, context);
+}
+
+template <const auto& Schema, auto Handler>
+void ParseThenCall(EmbeddedCli* cli, char* tokens, void* context)
+{
+    // default member initializers of the struct are the defaults
+    // of arguments which are not given
+    typename HandlerTraits<decltype(Handler)>::ArgsType args{};
+    if (ParseArgs(cli, std::data(Schema), std::size(Schema), tokens, &args))
+    {
+        Handler(cli, args, context);
+    }
+}
+
+} //namespace detail
+
+/**
+ * A required positional argument, e.g. Positional<&WriteArgs::address>("address").
+ * Integer values outside the range of the field are rejected.
+ */
+template <auto Member>
+constexpr ArgSpec Positional(const char* name)
+{
+    return detail::MakeSpec<Member>(name, ArgSpec::Kind::POSITIONAL);
+}
+
+/**
+ * A required positional integer argument limited to [min, max].
+ */
+template <auto Member>
+constexpr ArgSpec Positional(const char* name, detail::FieldOf<Member> min, detail::FieldOf<Member> max)
+{
+    static_assert(std::is_integral<detail::FieldOf<Member>>::value, "only integer arguments have a range");
+    return detail::MakeSpec<Member>(name, ArgSpec::Kind::POSITIONAL, detail::RangeBits(min), detail::RangeBits(max));
+}
+
+/**
+ * A positional argument which may be left out, keeping the field's
+ * default. Must follow all required positional arguments.
+ */
+template <auto Member>
+constexpr ArgSpec OptionalPositional(const char* name)
+{
+    return detail::MakeSpec<Member>(name, ArgSpec::Kind::OPTIONAL_POSITIONAL);
+}
+
+template <auto Member>
+constexpr ArgSpec OptionalPositional(const char* name, detail::FieldOf<Member> min, detail::FieldOf<Member> max)
+{
+    static_assert(std::is_integral<detail::FieldOf<Member>>::value, "only integer arguments have a range");
+    return detail::MakeSpec<Member>(name, ArgSpec::Kind::OPTIONAL_POSITIONAL, detail::RangeBits(min),
+                                    detail::RangeBits(max));
+}
+
+/**
+ * An option followed by its value, e.g. Option<&WriteArgs::count>("--count").
+ * The name must start with '-'.
+ */
+template <auto Member>
+constexpr ArgSpec Option(const char* name)
+{
+    return detail::MakeSpec<Member>(name, ArgSpec::Kind::OPTION);
+}
+
+template <auto Member>
+constexpr ArgSpec Option(const char* name, detail::FieldOf<Member> min, detail::FieldOf<Member> max)
+{
+    static_assert(std::is_integral<detail::FieldOf<Member>>::value, "only integer arguments have a range");
+    return detail::MakeSpec<Member>(name, ArgSpec::Kind::OPTION, detail::RangeBits(min), detail::RangeBits(max));
+}
+
+/**
+ * An option without a value, which sets a bool field, e.g.
+ * Flag<&WriteArgs::verify>("--verify"). The name must start with '-'.
+ */
+template <auto Member>
+constexpr ArgSpec Flag(const char* name)
+{
+    static_assert(std::is_same<detail::FieldOf<Member>, bool>::value, "flags set a bool field");
+    return detail::MakeSpec<Member>(name, ArgSpec::Kind::FLAG);
+}
+
+/**
+ * A command binding whose handler receives its arguments already
+ * parsed into a struct, instead of a string of tokens. The args are
+ * parsed by shared code, and bad input is rejected with a message
+ * before the handler is called. No heap is used. Usage:
+ *
+ *   struct WriteArgs { uint32_t address; uint8_t value; uint8_t count = 1; bool verify; };
+ *
+ *   constexpr ArgSpec WriteSchema[] = {
+ *       Positional<&WriteArgs::address>("address"),
+ *       Positional<&WriteArgs::value>("value"),
+ *       Option<&WriteArgs::count>("--count", 1, 16),
+ *       Flag<&WriteArgs::verify>("--verify"),
+ *   };
+ *
+ *   void OnWrite(EmbeddedCli* cli, const WriteArgs& args, void* context);
+ *
+ *   service.AddCliBindingAsync(ParsedCommand<WriteSchema, OnWrite>("write", "write <address> <value>"));
+ *
+ * String fields point into the command buffer, and are only valid
+ * during the handler call.
+ *
+ * @tparam Schema - an array of ArgSpec with static storage duration
+ * @tparam Handler - void (*)(EmbeddedCli*, const Args&, void* context)
+ */
+template <const auto& Schema, auto Handler>
+constexpr CommandBinding ParsedCommand(const char* name, const char* help, void* context = nullptr)
+{
+    using Args = typename detail::HandlerTraits<decltype(Handler)>::ArgsType;
+    static_assert(detail::SchemaIsFor(Schema, &detail::ArgsTypeTag<Args>::id),
+                  "every argument of the schema must be a field of the handler's argument struct");
+    static_assert(detail::HasValidNames(Schema), "options must start with '-', positional arguments must not");
+    static_assert(detail::HasRequiredPositionalsFirst(Schema),
+                  "optional positional arguments must follow the required ones");
+
+    return CommandBinding{name, help, true, context, &detail::ParseThenCall<Schema, Handler>};
+}
+
+/**
+ * A command binding whose handler receives its args already split into
+ * an argc/argv style index, rather than as a tokenized string:
+ *
+ *   void OnWrite(EmbeddedCli* cli, uint16_t argc, const CommandToken* argv, void* context);
+ *
+ *   service.AddCliBindingAsync(ArgvCommand<OnWrite, 80>("write", "write <address> <bytes>..."));
+ *
+ * The args are tokenized and indexed in a single pass, so a handler
+ * looping over many args does not rescan them for each one. The index
+ * is an array of MaxArgs tokens on the stack, no heap is used. More
+ * than MaxArgs args are rejected with a message, without calling the
+ * handler. Tokens are only valid during the handler call.
+ *
+ * @tparam Handler - void (*)(EmbeddedCli*, uint16_t argc, const CommandToken* argv, void* context)
+ * @tparam MaxArgs - size of the index
+ */
+template <auto Handler, uint16_t MaxArgs>
+constexpr CommandBinding ArgvCommand(const char* name, const char* help, void* context = nullptr)
+{
+    static_assert(std::is_same<decltype(Handler), detail::ArgvHandler>::value,
+                  "handler must be void (*)(EmbeddedCli*, uint16_t argc, const CommandToken* argv, void* context)");
+    static_assert(MaxArgs > 0, "at least one arg must be accepted");
+
+    //the args are tokenized while indexing them
+    return CommandBinding{name, help, false, context, &detail::TokenizeThenCall<Handler, MaxArgs>};
+}
+
+} //namespace EmbeddedCLI
+} //namespace cms
+
+#endif   // CMS_EMBEDDED_CLI_ARGS_HPP
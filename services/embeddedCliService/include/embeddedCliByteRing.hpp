@@ -0,0 +1,199 @@
+/// @brief  The Embedded-CLI Service, single producer/single consumer byte ring
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// License is noted in the service's LICENSE.txt file (MIT)
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+
+#ifndef CMS_EMBEDDED_CLI_BYTE_RING_HPP
+#define CMS_EMBEDDED_CLI_BYTE_RING_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <atomic>
+
+namespace cms {
+namespace EmbeddedCLI {
+
+/**
+ * A lock-free single producer/single consumer ring of bytes.
+ *
+ * The producer (typically a character device ISR or thread) only
+ * ever writes mHead, while the consumer (the CLI AO) writes mTail.
+ * The one exception is PushOverwrite(), where the producer discards
+ * the oldest bytes by advancing mTail, hence the consumer's
+ * compare-exchange in Pop(). Both indices are free running and wrap
+ * naturally, hence the power of two capacity requirement.
+ *
+ * @tparam Capacity - number of bytes held by the ring.
+ */
+template <size_t Capacity>
+class ByteRing {
+public:
+    static_assert((Capacity > 0) && ((Capacity & (Capacity - 1)) == 0),
+                  "ByteRing capacity must be a power of two");
+    static_assert(Capacity <= 0x8000u, "ByteRing capacity is too large");
+
+    ByteRing() : mBuffer(), mHead(0), mTail(0)
+    {
+    }
+
+    ByteRing(const ByteRing&)            = delete;
+    ByteRing& operator=(const ByteRing&) = delete;
+
+    /**
+     * Producer only. Copy as many of the given bytes into
+     * the ring as will fit.
+     * @return the number of bytes accepted.
+     */
+    size_t Push(const uint8_t* bytes, size_t length)
+    {
+        const uint16_t head = mHead.load(std::memory_order_relaxed);
+        const uint16_t tail = mTail.load(std::memory_order_acquire);
+        size_t space = Capacity - static_cast<uint16_t>(head - tail);
+        size_t count = (length < space) ? length : space;
+
+        Write(head, bytes, count);
+        mHead.store(static_cast<uint16_t>(head + count));
+        return count;
+    }
+
+    /**
+     * Producer only. Copy all of the given bytes into the ring,
+     * discarding the oldest bytes held by the ring as needed to
+     * make room. If length exceeds the capacity, only the last
+     * Capacity bytes are kept.
+     * @return the number of bytes discarded.
+     */
+    size_t PushOverwrite(const uint8_t* bytes, size_t length)
+    {
+        size_t discarded = 0;
+        if (length > Capacity)
+        {
+            discarded = length - Capacity;
+            bytes += discarded;
+            length = Capacity;
+        }
+
+        const uint16_t head = mHead.load(std::memory_order_relaxed);
+        uint16_t tail = mTail.load();
+        size_t space = Capacity - static_cast<uint16_t>(head - tail);
+        while (space < length)
+        {
+            // on failure, the consumer has freed some space
+            // and tail is reloaded, so re-evaluate.
+            uint16_t needed = static_cast<uint16_t>(length - space);
+            if (mTail.compare_exchange_weak(tail, static_cast<uint16_t>(tail + needed)))
+            {
+                discarded += needed;
+                break;
+            }
+            space = Capacity - static_cast<uint16_t>(head - tail);
+        }
+
+        Write(head, bytes, length);
+        mHead.store(static_cast<uint16_t>(head + length));
+        return discarded;
+    }
+
+    /**
+     * Consumer only. Move up to maxLength bytes out of the ring.
+     * @return the number of bytes copied into dest.
+     */
+    size_t Pop(uint8_t* dest, size_t maxLength)
+    {
+        uint16_t tail = mTail.load();
+        size_t count;
+        do {
+            // a failed exchange means PushOverwrite() discarded
+            // some of these bytes while they were being copied.
+            const uint16_t head = mHead.load();
+            size_t available = static_cast<uint16_t>(head - tail);
+            count = (maxLength < available) ? maxLength : available;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                dest[i] = mBuffer[static_cast<uint16_t>(tail + i) & MASK];
+            }
+        } while (!mTail.compare_exchange_weak(tail, static_cast<uint16_t>(tail + count)));
+
+        return count;
+    }
+
+    /**
+     * Consumer only. Copy up to maxLength of the oldest bytes without
+     * removing them. Not for use with PushOverwrite().
+     * @return the number of bytes copied into dest.
+     */
+    size_t Peek(uint8_t* dest, size_t maxLength) const
+    {
+        const uint16_t tail = mTail.load();
+        size_t available = static_cast<uint16_t>(mHead.load() - tail);
+        size_t count = (maxLength < available) ? maxLength : available;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            dest[i] = mBuffer[static_cast<uint16_t>(tail + i) & MASK];
+        }
+        return count;
+    }
+
+    /**
+     * Number of bytes currently held. Exact when called from the
+     * consumer, a snapshot otherwise.
+     */
+    size_t Count() const
+    {
+        return static_cast<uint16_t>(mHead.load() - mTail.load());
+    }
+
+    /**
+     * Producer only. The free running position at which the next
+     * pushed byte will be stored.
+     */
+    uint16_t ProducerPosition() const
+    {
+        return mHead.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Consumer only. Number of bytes which may be popped before
+     * reaching the given producer position. Zero if the position
+     * has already been reached or passed.
+     */
+    size_t CountUntil(uint16_t position) const
+    {
+        size_t distance = static_cast<uint16_t>(position - mTail.load());
+        return (distance <= Count()) ? distance : 0;
+    }
+
+    static constexpr size_t GetCapacity() { return Capacity; }
+
+private:
+    static constexpr uint16_t MASK = static_cast<uint16_t>(Capacity - 1);
+
+    void Write(uint16_t head, const uint8_t* bytes, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            mBuffer[static_cast<uint16_t>(head + i) & MASK] = bytes[i];
+        }
+    }
+
+    std::array<uint8_t, Capacity> mBuffer;
+    std::atomic<uint16_t> mHead;
+    std::atomic<uint16_t> mTail;
+};
+
+} //namespace EmbeddedCLI
+} //namespace cms
+
+#endif   // CMS_EMBEDDED_CLI_BYTE_RING_HPP
@@ -16,12 +16,17 @@
 #define CMS_EMBEDDED_CLI_COMMAND_BINDING_HPP
 
 #include <cstdbool>
+#include <cstdint>
+#include <type_traits>
 
 // forward declare the third-party EmbeddedCli structs
 struct EmbeddedCli;
 
 namespace cms {
 namespace EmbeddedCLI {   // note, all caps CLI needed to avoid conflicts
+
+struct CommandBindingTable;
+
 /**
  * This is basically a copy of the same struct from embedded-cli.
  * Going a bit out of my way to avoid exposing embedded-cli details
@@ -58,8 +63,171 @@ struct CommandBinding {
      * @param context
      */
     void (*binding)(EmbeddedCli* cli, char* args, void* context);
+
+    /**
+     * Optional table of subcommands, making this binding a group,
+     * e.g. "net" with "if" and "ping". When the args start with a
+     * subcommand name, that subcommand is called with the rest of
+     * the args instead. Subcommands may be groups as well. A group
+     * with a null binding function prints its subcommands.
+     * The table is referenced in place, e.g. a
+     * StaticCommandTable<...>::Get().
+     */
+    const CommandBindingTable* subcommands = nullptr;
+};
+
+/**
+ * Copy of the embedded-cli token of tokenized command args,
+ * see TokenizeArgs() and ArgvCommand().
+ */
+struct CommandToken {
+    /**
+     * Null terminated token, within the command's args.
+     */
+    const char* str;
+
+    uint16_t len;
 };
 
+/**
+ * Copy of the embedded-cli perfect hash over the names of a
+ * CommandBindingTable. Not meant to be filled in by hand, see
+ * embeddedCliCommandTable.hpp, which builds one at compile time.
+ */
+struct CommandBindingHash {
+    const uint16_t* slots;
+    const uint16_t* displacements;
+    uint16_t slotCount;
+    uint16_t bucketCount;
+    uint32_t seed;
+};
+
+/**
+ * A table of command bindings which the CLI references in place,
+ * rather than copying, so the table may reside in flash.
+ */
+struct CommandBindingTable {
+    /**
+     * Bindings, preferably sorted by name, as bindings which are not
+     * sorted are searched linearly. Names must be unique.
+     */
+    const CommandBinding* bindings;
+
+    uint16_t count;
+
+    /**
+     * Optional perfect hash over the binding names. If nullptr,
+     * a binary search is used instead.
+     */
+    const CommandBindingHash* hash;
+};
+
+#if defined(__cpp_nontype_template_parameter_auto)
+
+namespace detail {
+
+template <typename Method>
+struct MethodTraits;
+
+template <typename Class>
+struct MethodTraits<void (Class::*)(EmbeddedCli*, char*)> {
+    using Object = Class;
+};
+
+template <typename Class>
+struct MethodTraits<void (Class::*)(EmbeddedCli*, char*) const> {
+    using Object = const Class;
+};
+
+template <auto Method>
+void CallMethod(EmbeddedCli* cli, char* args, void* context)
+{
+    using Object = typename MethodTraits<decltype(Method)>::Object;
+    (static_cast<Object*>(context)->*Method)(cli, args);
+}
+
+template <const auto& Lambda, typename Object>
+void CallLambda(EmbeddedCli* cli, char* args, void* context)
+{
+    Lambda(*static_cast<Object*>(context), cli, args);
+}
+
+// the context is only ever cast back to the object's own type,
+// so const objects keep their constness
+template <typename Object>
+constexpr void* ContextOf(Object& object)
+{
+    return const_cast<void*>(static_cast<const void*>(&object));
+}
+
+} //namespace detail
+
+/**
+ * A command binding which calls a member function of the given object:
+ *
+ *   class Motor {
+ *   public:
+ *       void OnSpeed(EmbeddedCli* cli, char* args);
+ *   };
+ *
+ *   service.AddCliBindingAsync(MemberCommand<&Motor::OnSpeed>("speed", "speed <rpm>", motor));
+ *
+ * The binding function is generated at compile time, and the object
+ * is passed as the binding's context, so no heap is used and handlers
+ * need not cast the context themselves. The object must outlive the
+ * binding.
+ *
+ * @tparam Method - void (Class::*)(EmbeddedCli*, char* args), may be const
+ * @param object - whose member function is called
+ * @param tokenizeArgs - see CommandBinding::tokenizeArgs
+ */
+template <auto Method>
+constexpr CommandBinding MemberCommand(const char* name, const char* help,
+                                       typename detail::MethodTraits<decltype(Method)>::Object& object,
+                                       bool tokenizeArgs = false)
+{
+    return CommandBinding{name, help, tokenizeArgs, detail::ContextOf(object), &detail::CallMethod<Method>};
+}
+
+// a temporary object, such as may bind to a const member function's
+// object, would leave the binding with a dangling context.
+template <auto Method>
+CommandBinding MemberCommand(const char* name, const char* help,
+                             const typename detail::MethodTraits<decltype(Method)>::Object&& object,
+                             bool tokenizeArgs = false) = delete;
+
+/**
+ * A command binding which calls a capture-less lambda with the given
+ * object, rather than a member function:
+ *
+ *   static constexpr auto onStop = [](Motor& motor, EmbeddedCli* cli, char* args) { motor.Stop(); };
+ *
+ *   service.AddCliBindingAsync(LambdaCommand<onStop>("stop", "stops the motor", motor));
+ *
+ * As with MemberCommand(), the binding function is generated at compile
+ * time. The lambda must be a named constexpr, as C++17 does not allow a
+ * lambda expression as a template argument.
+ *
+ * @tparam Lambda - capture-less, called as (Object&, EmbeddedCli*, char* args)
+ * @param object - passed to the lambda
+ * @param tokenizeArgs - see CommandBinding::tokenizeArgs
+ */
+template <const auto& Lambda, typename Object>
+constexpr CommandBinding LambdaCommand(const char* name, const char* help, Object& object, bool tokenizeArgs = false)
+{
+    static_assert(std::is_convertible<decltype(Lambda), void (*)(Object&, EmbeddedCli*, char*)>::value,
+                  "lambda must be capture-less, and called as (Object&, EmbeddedCli*, char* args)");
+
+    return CommandBinding{name, help, tokenizeArgs, detail::ContextOf(object), &detail::CallLambda<Lambda, Object>};
+}
+
+// as for MemberCommand(), temporary objects are rejected
+template <const auto& Lambda, typename Object>
+CommandBinding LambdaCommand(const char* name, const char* help, const Object&& object,
+                             bool tokenizeArgs = false) = delete;
+
+#endif   // __cpp_nontype_template_parameter_auto
+
 } //namespace EmbeddedCLI
 } //namespace cms
 
@@ -0,0 +1,306 @@
+/// @brief  The Embedded-CLI Service, compile time command binding tables
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// License is noted in the service's LICENSE.txt file (MIT)
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+
+#ifndef CMS_EMBEDDED_CLI_COMMAND_TABLE_HPP
+#define CMS_EMBEDDED_CLI_COMMAND_TABLE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <iterator>
+#include "embeddedCliCommandBinding.hpp"
+
+namespace cms {
+namespace EmbeddedCLI {
+namespace detail {
+
+constexpr int CompareNames(const char* a, const char* b)
+{
+    while ((*a != '\0') && (*a == *b))
+    {
+        ++a;
+        ++b;
+    }
+    return static_cast<int>(static_cast<uint8_t>(*a)) - static_cast<int>(static_cast<uint8_t>(*b));
+}
+
+// must match the hash used by embedded-cli, see CliBindingHash
+constexpr uint32_t HashName(const char* name, uint32_t seed)
+{
+    uint32_t h = seed;
+    for (; *name != '\0'; ++name)
+    {
+        h = (h ^ static_cast<uint8_t>(*name)) * 16777619u;
+    }
+    return h;
+}
+
+constexpr uint32_t HashSlot(uint32_t h, uint32_t displacement, uint32_t slotCount)
+{
+    uint32_t g = h * 0x9E3779B1u;
+    return ((g >> 16) + displacement * ((g & 0xFFFFu) | 1u)) & (slotCount - 1u);
+}
+
+constexpr size_t NextPowerOfTwo(size_t n)
+{
+    size_t p = 1;
+    while (p < n)
+    {
+        p <<= 1;
+    }
+    return p;
+}
+
+template <size_t N>
+constexpr std::array<CommandBinding, N> SortByName(const CommandBinding (&bindings)[N])
+{
+    // insertion sort, which is plenty for compile time
+    std::array<CommandBinding, N> sorted{};
+    for (size_t i = 0; i < N; ++i)
+    {
+        size_t j = i;
+        while ((j > 0) && (CompareNames(sorted[j - 1].name, bindings[i].name) > 0))
+        {
+            sorted[j] = sorted[j - 1];
+            --j;
+        }
+        sorted[j] = bindings[i];
+    }
+    return sorted;
+}
+
+template <size_t N>
+constexpr bool HasValidNames(const CommandBinding (&bindings)[N])
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        if ((bindings[i].name == nullptr) || (bindings[i].name[0] == '\0'))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <size_t N>
+constexpr bool HasUniqueNames(const std::array<CommandBinding, N>& sorted)
+{
+    for (size_t i = 1; i < N; ++i)
+    {
+        if (CompareNames(sorted[i - 1].name, sorted[i].name) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <size_t SlotCount, size_t BucketCount>
+struct PerfectHash {
+    static constexpr uint16_t EMPTY_SLOT = 0xFFFF;
+
+    std::array<uint16_t, SlotCount> slots;
+    std::array<uint16_t, BucketCount> displacements;
+    uint32_t seed;
+    bool valid;
+};
+
+/**
+ * Hash and displace: names are hashed into buckets, then, largest
+ * bucket first, a displacement is searched for which moves every
+ * name of the bucket into a free slot.
+ */
+template <size_t SlotCount, size_t BucketCount, size_t N>
+constexpr bool TryBuildPerfectHash(const std::array<CommandBinding, N>& sorted, uint32_t seed,
+                                   PerfectHash<SlotCount, BucketCount>& result)
+{
+    using Hash = PerfectHash<SlotCount, BucketCount>;
+
+    std::array<uint32_t, N> hashes{};
+    std::array<size_t, BucketCount + 1> bucketStart{};
+    for (size_t i = 0; i < N; ++i)
+    {
+        hashes[i] = HashName(sorted[i].name, seed);
+        ++bucketStart[(hashes[i] % BucketCount) + 1];
+    }
+
+    // names with equal hashes can never be told apart, try another seed
+    for (size_t i = 0; i < N; ++i)
+    {
+        for (size_t j = i + 1; j < N; ++j)
+        {
+            if (hashes[i] == hashes[j])
+            {
+                return false;
+            }
+        }
+    }
+
+    // group the names by bucket
+    size_t largestBucket = 0;
+    for (size_t bucket = 0; bucket < BucketCount; ++bucket)
+    {
+        size_t size = bucketStart[bucket + 1];
+        largestBucket = (size > largestBucket) ? size : largestBucket;
+        bucketStart[bucket + 1] = bucketStart[bucket] + size;
+    }
+
+    std::array<uint16_t, N> byBucket{};
+    std::array<size_t, BucketCount> filled{};
+    for (size_t i = 0; i < N; ++i)
+    {
+        size_t bucket = hashes[i] % BucketCount;
+        byBucket[bucketStart[bucket] + filled[bucket]] = static_cast<uint16_t>(i);
+        ++filled[bucket];
+    }
+
+    for (size_t i = 0; i < SlotCount; ++i)
+    {
+        result.slots[i] = Hash::EMPTY_SLOT;
+    }
+
+    for (size_t size = largestBucket; size > 0; --size)
+    {
+        for (size_t bucket = 0; bucket < BucketCount; ++bucket)
+        {
+            if ((bucketStart[bucket + 1] - bucketStart[bucket]) != size)
+            {
+                continue;
+            }
+
+            bool placed = false;
+            // slots repeat once the displacement reaches the slot count
+            for (uint32_t d = 0; !placed && (d < SlotCount); ++d)
+            {
+                size_t k = bucketStart[bucket];
+                for (; k < bucketStart[bucket + 1]; ++k)
+                {
+                    uint32_t slot = HashSlot(hashes[byBucket[k]], d, SlotCount);
+                    if (result.slots[slot] != Hash::EMPTY_SLOT)
+                    {
+                        break;
+                    }
+                    result.slots[slot] = byBucket[k];
+                }
+
+                placed = (k == bucketStart[bucket + 1]);
+                if (placed)
+                {
+                    result.displacements[bucket] = static_cast<uint16_t>(d);
+                }
+                else
+                {
+                    // undo a partial placement of this bucket
+                    while (k > bucketStart[bucket])
+                    {
+                        --k;
+                        result.slots[HashSlot(hashes[byBucket[k]], d, SlotCount)] = Hash::EMPTY_SLOT;
+                    }
+                }
+            }
+
+            if (!placed)
+            {
+                return false;
+            }
+        }
+    }
+
+    result.seed = seed;
+    return true;
+}
+
+template <size_t SlotCount, size_t BucketCount, size_t N>
+constexpr PerfectHash<SlotCount, BucketCount> BuildPerfectHash(const std::array<CommandBinding, N>& sorted)
+{
+    constexpr uint32_t FNV_OFFSET_BASIS = 2166136261u;
+    constexpr uint32_t MAX_SEED_ATTEMPTS = 64;
+
+    PerfectHash<SlotCount, BucketCount> result{};
+    if (!HasUniqueNames(sorted))
+    {
+        return result;
+    }
+
+    for (uint32_t attempt = 0; attempt < MAX_SEED_ATTEMPTS; ++attempt)
+    {
+        if (TryBuildPerfectHash(sorted, FNV_OFFSET_BASIS + attempt, result))
+        {
+            result.valid = true;
+            break;
+        }
+    }
+    return result;
+}
+
+} //namespace detail
+
+/**
+ * A command binding table built entirely at compile time from a
+ * statically declared array of bindings. The bindings are sorted by
+ * name and indexed by a perfect hash, so the CLI finds a command with
+ * a single hash and string compare, regardless of the number of
+ * commands. Duplicate or missing names fail to compile.
+ *
+ * The table resides in read-only memory and is referenced, not
+ * copied, by the CLI. Usage:
+ *
+ *   constexpr CommandBinding MyCommands[] = { {"get", ...}, {"set", ...} };
+ *   service.AddCliBindingTableAsync(StaticCommandTable<MyCommands>::Get());
+ *
+ * @tparam Bindings - an array of bindings with static storage duration.
+ */
+template <const auto& Bindings>
+class StaticCommandTable {
+public:
+    StaticCommandTable() = delete;
+
+    static constexpr const CommandBindingTable& Get() { return mTable; }
+
+private:
+    static constexpr size_t COUNT = std::size(Bindings);
+    static_assert(COUNT < 0xFFFF, "too many bindings for a single table");
+    static_assert(detail::HasValidNames(Bindings), "every binding in a table must have a name");
+
+    static constexpr std::array<CommandBinding, COUNT> mSorted = detail::SortByName(Bindings);
+    static_assert(detail::HasUniqueNames(mSorted), "binding names in a table must be unique");
+
+    //a load factor of at most 0.8, two names per bucket on average
+    static constexpr size_t SLOT_COUNT = detail::NextPowerOfTwo(COUNT + (COUNT / 4) + 1);
+    static constexpr size_t BUCKET_COUNT = (COUNT / 2) + 1;
+    static_assert(SLOT_COUNT <= 0x8000u, "too many bindings for a single table");
+
+    static constexpr detail::PerfectHash<SLOT_COUNT, BUCKET_COUNT> mPerfectHash =
+        detail::BuildPerfectHash<SLOT_COUNT, BUCKET_COUNT>(mSorted);
+    static_assert(mPerfectHash.valid || !detail::HasUniqueNames(mSorted), "unable to build a perfect hash for this table");
+
+    static constexpr CommandBindingHash mHash = {
+        mPerfectHash.slots.data(),
+        mPerfectHash.displacements.data(),
+        static_cast<uint16_t>(SLOT_COUNT),
+        static_cast<uint16_t>(BUCKET_COUNT),
+        mPerfectHash.seed
+    };
+
+    static constexpr CommandBindingTable mTable = {
+        mSorted.data(),
+        static_cast<uint16_t>(COUNT),
+        &mHash
+    };
+};
+
+} //namespace EmbeddedCLI
+} //namespace cms
+
+#endif   // CMS_EMBEDDED_CLI_COMMAND_TABLE_HPP
@@ -0,0 +1,127 @@
+/// @brief  The Embedded-CLI Service, formatted printing
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// License is noted in the service's LICENSE.txt file (MIT)
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+
+#ifndef CMS_EMBEDDED_CLI_FORMAT_HPP
+#define CMS_EMBEDDED_CLI_FORMAT_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+//forward declare the third-party EmbeddedCli struct
+struct EmbeddedCli;
+
+namespace cms {
+namespace EmbeddedCLI {
+
+/**
+ * A single argument of PrintFormatted(), created implicitly from
+ * integers, chars, strings and pointers. Any other type fails to
+ * compile, including floating point and enum values, which would
+ * otherwise be converted to a char.
+ */
+class FormatArg {
+public:
+    enum class Type : uint8_t {
+        SIGNED,
+        UNSIGNED,
+        CHAR,
+        STRING,
+        POINTER
+    };
+
+    template <typename T>
+    struct IsInteger : std::integral_constant<bool, std::is_integral<T>::value && !std::is_same<T, char>::value> {
+    };
+
+    template <typename T, typename std::enable_if<IsInteger<T>::value && std::is_signed<T>::value, int>::type = 0>
+    constexpr FormatArg(T value) : mType(Type::SIGNED), mSize(sizeof(T)), mSigned(value)
+    {
+    }
+
+    template <typename T, typename std::enable_if<IsInteger<T>::value && !std::is_signed<T>::value, int>::type = 0>
+    constexpr FormatArg(T value) : mType(Type::UNSIGNED), mSize(sizeof(T)), mUnsigned(value)
+    {
+    }
+
+    //a template, so only a char matches, without any conversion
+    template <typename T, typename std::enable_if<std::is_same<T, char>::value, int>::type = 0>
+    constexpr FormatArg(T value) : mType(Type::CHAR), mSize(sizeof(char)), mChar(value)
+    {
+    }
+
+    constexpr FormatArg(const char* value) : mType(Type::STRING), mSize(sizeof(value)), mString(value)
+    {
+    }
+
+    constexpr FormatArg(const void* value) : mType(Type::POINTER), mSize(sizeof(value)), mPointer(value)
+    {
+    }
+
+    Type mType;
+    uint8_t mSize;  ///< of the original value, in bytes
+    union {
+        int64_t mSigned;
+        uint64_t mUnsigned;
+        char mChar;
+        const char* mString;
+        const void* mPointer;
+    };
+};
+
+/**
+ * PrintFormatted() with its arguments collected in an array, so the
+ * formatting code is shared by all argument lists.
+ */
+void PrintFormattedArgs(EmbeddedCli* cli, const char* format, const FormatArg* args, size_t argCount);
+
+/**
+ * Prints a line of formatted text, as embeddedCliPrint() does,
+ * without an intermediate buffer: each character is written to
+ * the CLI output as it is produced. No heap is used.
+ *
+ * The format uses printf style directives:
+ *   %[-][0][width]conversion
+ * where conversion is d, i or u (decimal), x or X (hex), c (char),
+ * s (string), p (pointer) or % (a percent sign). Length modifiers,
+ * such as l or z, are accepted and ignored: the type of each
+ * argument is known, so it is always printed correctly. A
+ * conversion only selects how an integer or char is shown, e.g.
+ * %d of a string still prints the string. Directives without a
+ * matching argument are printed as is, and extra arguments are
+ * ignored.
+ *
+ * Usage, e.g. within a command binding:
+ *   PrintFormatted(cli, "sensor %s: %d mV (0x%04x)", name, millivolts, raw);
+ *
+ * @param cli - as provided to the command binding
+ * @param format - null terminated
+ * @param args - integers, chars, strings or pointers
+ */
+template <typename... Args>
+void PrintFormatted(EmbeddedCli* cli, const char* format, const Args&... args)
+{
+    const FormatArg formatArgs[] = {FormatArg(args)...};
+    PrintFormattedArgs(cli, format, formatArgs, sizeof...(Args));
+}
+
+inline void PrintFormatted(EmbeddedCli* cli, const char* format)
+{
+    PrintFormattedArgs(cli, format, nullptr, 0);
+}
+
+} //namespace EmbeddedCLI
+} //namespace cms
+
+#endif   // CMS_EMBEDDED_CLI_FORMAT_HPP
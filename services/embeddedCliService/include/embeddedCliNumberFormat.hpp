@@ -0,0 +1,100 @@
+/// @brief  The Embedded-CLI Service, fast number formatting and hexdump
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// License is noted in the service's LICENSE.txt file (MIT)
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+
+#ifndef CMS_EMBEDDED_CLI_NUMBER_FORMAT_HPP
+#define CMS_EMBEDDED_CLI_NUMBER_FORMAT_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+//forward declare the third-party EmbeddedCli struct
+struct EmbeddedCli;
+
+namespace cms {
+namespace EmbeddedCLI {
+
+/**
+ * Formatters for command bindings printing numbers, e.g. register
+ * values, in place of sprintf(). Each writes into a caller provided
+ * buffer, null terminates it and returns the number of chars written,
+ * not counting the terminator. Values fitting 32 bits never use 64 bit
+ * division, which is slow on most microcontrollers.
+ */
+
+/// large enough for any value of the formatters below, including the terminator
+constexpr size_t DECIMAL_BUFFER_SIZE = 21;
+constexpr size_t HEX_BUFFER_SIZE = 17;
+constexpr size_t FIXED_POINT_BUFFER_SIZE = 23;
+
+/// most digits after the decimal point of FormatFixedPoint()
+constexpr uint8_t MAX_FRACTION_DIGITS = 19;
+
+/**
+ * Formats an unsigned value as decimal, like "%llu".
+ * @param value
+ * @param dest - at least DECIMAL_BUFFER_SIZE chars
+ * @return number of chars written
+ */
+size_t FormatDecimal(uint64_t value, char* dest);
+
+/**
+ * Formats a signed value as decimal, like "%lld".
+ * @param value
+ * @param dest - at least DECIMAL_BUFFER_SIZE chars
+ * @return number of chars written
+ */
+size_t FormatSignedDecimal(int64_t value, char* dest);
+
+/**
+ * Formats a value as hex, zero padded to at least minDigits,
+ * e.g. FormatHex(0x1F, 8, dest) writes "0000001f" like "%08lx".
+ * @param value
+ * @param minDigits - 0 or 1 print at least one digit, more than 16 are clamped
+ * @param dest - at least HEX_BUFFER_SIZE chars
+ * @param upperCase - true for "%X" digits
+ * @return number of chars written
+ */
+size_t FormatHex(uint64_t value, uint8_t minDigits, char* dest, bool upperCase = false);
+
+/**
+ * Formats a fixed-point value counted in units of 10^-fractionDigits,
+ * e.g. millivolts as volts: FormatFixedPoint(-1250, 3, dest) writes
+ * "-1.250". No floating point is used.
+ * @param scaledValue
+ * @param fractionDigits - digits after the decimal point, 0 omits the point,
+ *                         more than MAX_FRACTION_DIGITS are clamped
+ * @param dest - at least FIXED_POINT_BUFFER_SIZE chars
+ * @return number of chars written
+ */
+size_t FormatFixedPoint(int64_t scaledValue, uint8_t fractionDigits, char* dest);
+
+/**
+ * Prints memory in the canonical hexdump layout, one line per 16
+ * bytes, as embeddedCliPrint() would print each line:
+ *   20000100  48 65 6c 6c 6f 00 01 02  03 04 05 06 07 08 09 0a  |Hello...........|
+ * Each line is streamed straight to the CLI output, without a buffer
+ * or sprintf(). The address column widens to 16 digits when needed.
+ *
+ * @param cli - as provided to the command binding
+ * @param data - memory to dump
+ * @param length - in bytes
+ * @param displayAddress - address shown for the first byte, e.g. the
+ *                         address in the target's memory map
+ */
+void PrintHexDump(EmbeddedCli* cli, const void* data, size_t length, uintptr_t displayAddress);
+
+} //namespace EmbeddedCLI
+} //namespace cms
+
+#endif   // CMS_EMBEDDED_CLI_NUMBER_FORMAT_HPP
@@ -18,13 +18,108 @@
 #include <cstdint>
 #include <cstddef>
 #include <array>
+#include <atomic>
 #include "qpcpp.hpp"
 #include "pubsub_signals.hpp"
 #include "characterDeviceInterface.hpp"
 #include "embeddedCliCommandBinding.hpp"
 #include "embeddedCliEvent.hpp"
+#include "embeddedCliByteRing.hpp"
 #include "cms_embedded_cli_signal_range.hpp"
 
+// Size of the receive ring between the character device callback
+// and the CLI AO. Must be a power of two. Projects with larger
+// receive bursts may override this value.
+#ifndef CMS_EMBEDDED_CLI_RX_RING_SIZE
+#define CMS_EMBEDDED_CLI_RX_RING_SIZE 256
+#endif
+
+// Receive flow control watermarks, in bytes held by the receive ring.
+// The remote sender is asked to pause once the ring reaches the high
+// watermark, and to resume once it drains to the low watermark.
+// The space above the high watermark must absorb any bytes already
+// in flight when the sender is paused.
+#ifndef CMS_EMBEDDED_CLI_RX_HIGH_WATERMARK
+#define CMS_EMBEDDED_CLI_RX_HIGH_WATERMARK ((CMS_EMBEDDED_CLI_RX_RING_SIZE * 3) / 4)
+#endif
+
+#ifndef CMS_EMBEDDED_CLI_RX_LOW_WATERMARK
+#define CMS_EMBEDDED_CLI_RX_LOW_WATERMARK (CMS_EMBEDDED_CLI_RX_RING_SIZE / 4)
+#endif
+
+// Size of the ring holding CLI output until the character device
+// accepts it. Output is handed to the device once per event, and
+// again whenever the device reports it is ready for more. Must be
+// a power of two.
+#ifndef CMS_EMBEDDED_CLI_TX_RING_SIZE
+#define CMS_EMBEDDED_CLI_TX_RING_SIZE 512
+#endif
+
+// Clock ticks, at tick rate 0, after which output refused by the
+// character device is retried. Devices without a write ready
+// callback are only retried this way, otherwise it is a fallback.
+#ifndef CMS_EMBEDDED_CLI_TX_RETRY_TICKS
+#define CMS_EMBEDDED_CLI_TX_RETRY_TICKS 1
+#endif
+
+// Size of the ring holding command output which is waiting for its
+// share of the transmit ring, see SetBulkOutputShare(). When a command
+// fills it, the command waits for the character device, as it would
+// with a blocking write, which holds up the AO. Commands with more
+// output than this should produce it lazily, see
+// embeddedCliSetOutputProducer(). Must be a power of two.
+#ifndef CMS_EMBEDDED_CLI_BULK_RING_SIZE
+#define CMS_EMBEDDED_CLI_BULK_RING_SIZE 1024
+#endif
+
+// Write attempts in a row, all refused by the character device,
+// after which a command waiting for room in full output rings gives
+// up, and its further output is dropped until the device accepts
+// output again. This only guards against a device which stopped
+// writing altogether, e.g. a disconnected USB CDC port.
+#ifndef CMS_EMBEDDED_CLI_TX_STALL_RETRIES
+#define CMS_EMBEDDED_CLI_TX_STALL_RETRIES 1000000
+#endif
+
+// The most tables of bindings which may be added, each with
+// AddCliBindingTableAsync() or AddCliBindingsAsync(), e.g. one per
+// module registering its own flash resident commands.
+#ifndef CMS_EMBEDDED_CLI_MAX_BINDING_TABLES
+#define CMS_EMBEDDED_CLI_MAX_BINDING_TABLES 4
+#endif
+
+// Sizes, in bytes, of the pooled events carrying text for
+// Service::PrintAsync(). Text is copied into the smallest of these
+// events which fits it, so the application must initialize QF event
+// pools with blocks of these sizes before printing. A pool of the
+// smallest size also serves Service::PrintStaticAsync().
+#ifndef CMS_EMBEDDED_CLI_PRINT_SMALL_EVENT_SIZE
+#define CMS_EMBEDDED_CLI_PRINT_SMALL_EVENT_SIZE 32
+#endif
+
+#ifndef CMS_EMBEDDED_CLI_PRINT_MEDIUM_EVENT_SIZE
+#define CMS_EMBEDDED_CLI_PRINT_MEDIUM_EVENT_SIZE 64
+#endif
+
+#ifndef CMS_EMBEDDED_CLI_PRINT_LARGE_EVENT_SIZE
+#define CMS_EMBEDDED_CLI_PRINT_LARGE_EVENT_SIZE 128
+#endif
+
+// Links at or below this baud rate are rendered with the low bandwidth
+// profile, see Service::ProfileForBaud().
+#ifndef CMS_EMBEDDED_CLI_LOW_BANDWIDTH_BAUD
+#define CMS_EMBEDDED_CLI_LOW_BANDWIDTH_BAUD 19200u
+#endif
+
+static_assert((CMS_EMBEDDED_CLI_TX_RING_SIZE & (CMS_EMBEDDED_CLI_TX_RING_SIZE - 1)) == 0,
+              "transmit ring size must be a power of two");
+static_assert(CMS_EMBEDDED_CLI_TX_RING_SIZE <= 0x8000u, "transmit ring size is too large");
+
+static_assert(CMS_EMBEDDED_CLI_RX_LOW_WATERMARK < CMS_EMBEDDED_CLI_RX_HIGH_WATERMARK,
+              "receive low watermark must be below the high watermark");
+static_assert(CMS_EMBEDDED_CLI_RX_HIGH_WATERMARK <= CMS_EMBEDDED_CLI_RX_RING_SIZE,
+              "receive high watermark must not exceed the ring size");
+
 //forward declare the third-party EmbeddedCli structs
 struct EmbeddedCli;
 struct EmbeddedCliConfig;
@@ -54,6 +149,38 @@ using CliUint = uint64_t;
  */
 class Service final : public QP::QActive {
 public:
+    /**
+     * What to do with received bytes when the receive ring is full,
+     * i.e. input is arriving faster than the CLI can process it.
+     */
+    enum class OverloadPolicy : uint8_t {
+        DROP_NEWEST,        ///< discard the bytes that do not fit
+        DROP_OLDEST,        ///< discard the oldest bytes to make room
+        MARK_LINE_CORRUPT   ///< discard the newest bytes, and do not
+                            ///< execute the line they belonged to
+    };
+
+    /**
+     * How the CLI draws the line being edited.
+     */
+    enum class RenderProfile : uint8_t {
+        STANDARD,       ///< live autocompletion hints, escape sequences
+                        ///< for all cursor movement
+        LOW_BANDWIDTH   ///< no live autocompletion hints (and so no
+                        ///< cursor save/restore), shortest form cursor
+                        ///< movement. Tab completion still works.
+    };
+
+    /**
+     * @param baudRate - of the link to the character device
+     * @return the render profile suited to the given link speed.
+     */
+    static constexpr RenderProfile ProfileForBaud(uint32_t baudRate)
+    {
+        return (baudRate <= CMS_EMBEDDED_CLI_LOW_BANDWIDTH_BAUD) ? RenderProfile::LOW_BANDWIDTH
+                                                                 : RenderProfile::STANDARD;
+    }
+
     /**
      * Constructor
      * @param buffer - set to nullptr and the internal CLI will malloc
@@ -64,8 +191,11 @@ public:
      *                          use internal default value.
      * @param customInvitation - a custom string for the CLI prompt.
      *                           Set to nullptr for the internal default prompt
+     * @param profile - how the line being edited is drawn, see
+     *                  ProfileForBaud() for slow links.
      */
-    explicit Service(CliUint* buffer, size_t bufferElementCount, uint16_t maxBindingCount, const char * customInvitation = nullptr);
+    explicit Service(CliUint* buffer, size_t bufferElementCount, uint16_t maxBindingCount, const char * customInvitation = nullptr,
+                     RenderProfile profile = RenderProfile::STANDARD);
     ~Service();
 
     Service(const Service&)            = delete;
@@ -89,22 +219,156 @@ public:
      *
      * Will assert if the AO is not active.
      * Will assert if no free bindings are available.
+     * Will assert if the binding has neither a binding function
+     * nor subcommands.
      *
      * @param binding
      */
     void AddCliBindingAsync(const CommandBinding& binding);
 
+    /**
+     * Asynchronously add a table of CLI command bindings to the
+     * embedded-cli managed by this AO. The table itself is copied,
+     * but its bindings are referenced, not copied, and so must
+     * outlive the CLI session. See StaticCommandTable for building
+     * tables at compile time.
+     *
+     * Will assert if the AO is not active.
+     * Will assert if no free binding tables are available,
+     * see CMS_EMBEDDED_CLI_MAX_BINDING_TABLES.
+     *
+     * @param table
+     */
+    void AddCliBindingTableAsync(const CommandBindingTable& table);
+
+    /**
+     * Asynchronously add an array of CLI command bindings, e.g. a
+     * const array residing in flash, with a single event. As with
+     * AddCliBindingTableAsync(), the bindings are referenced in
+     * place, so they use neither RAM nor the bindings counted by
+     * maxBindingCount. Bindings may be in any order, though a
+     * large array sorted by name is searched faster.
+     *
+     * Will assert if the AO is not active.
+     * Will assert if no free binding tables are available,
+     * see CMS_EMBEDDED_CLI_MAX_BINDING_TABLES.
+     *
+     * @param bindings - must outlive the CLI session
+     * @param count
+     */
+    void AddCliBindingsAsync(const CommandBinding* bindings, uint16_t count);
+
+    template <size_t N>
+    void AddCliBindingsAsync(const CommandBinding (&bindings)[N])
+    {
+        static_assert(N < 0xFFFF, "too many bindings for a single table");
+        AddCliBindingsAsync(bindings, static_cast<uint16_t>(N));
+    }
+
     /**
      *   Will asynchronously stop and release all CLI resources.
      */
     void EndCliAsync();
 
+    /**
+     * Asynchronously print a line of text, e.g. a progress report
+     * from another active object. The text is printed above the
+     * line being edited, which is then drawn again, so the user's
+     * input is not corrupted. A line break is added.
+     *
+     * The text is copied into a pooled event, so it may be reused
+     * as soon as this returns. Text which does not fit the largest
+     * event, see CMS_EMBEDDED_CLI_PRINT_LARGE_EVENT_SIZE, is
+     * truncated. Text printed while the CLI is not active is
+     * discarded.
+     *
+     * May be called freely from any active object, at any priority.
+     * When the event pool or this AO's queue is nearly exhausted,
+     * e.g. by a burst of progress reports, the text is dropped and
+     * counted rather than asserting, see GetDroppedPrintCount().
+     * The application must have initialized event pools for the
+     * three size classes, see CMS_EMBEDDED_CLI_PRINT_SMALL_EVENT_SIZE.
+     *
+     * @param text - null terminated
+     * @return false if the text was dropped
+     */
+    bool PrintAsync(const char* text);
+
+    /**
+     * As PrintAsync(), but the text is referenced rather than
+     * copied, and is never truncated.
+     *
+     * @param text - null terminated, with static storage duration,
+     *               e.g. a string literal.
+     * @return false if the text was dropped
+     */
+    bool PrintStaticAsync(const char* text);
+
+    /**
+     * Select how received input is dropped when arriving faster than
+     * the CLI can process it. Defaults to MARK_LINE_CORRUPT.
+     * Call before BeginCliAsync().
+     * @param policy
+     */
+    void SetOverloadPolicy(OverloadPolicy policy) { mOverloadPolicy = policy; }
+
+    /**
+     * Output is scheduled in two classes: interactive output, such
+     * as echo of typed characters and the prompt, and bulk output,
+     * written by commands. Interactive output is always queued for
+     * the character device first. Bulk output may only fill this
+     * percentage of the transmit ring, bounding how long typed
+     * characters wait behind it. The remainder is written, unchanged,
+     * above the line being edited as the device catches up.
+     * Defaults to 25. Call before BeginCliAsync().
+     * @param percent - 1 to 100
+     */
+    void SetBulkOutputShare(uint8_t percent);
+
+    /**
+     * Enables the pager: after this many lines of command output,
+     * production of lazily produced output, such as the help
+     * listing, pauses at a --More-- prompt until a key is pressed.
+     * 'q' or Ctrl-C ends the output, any other key shows the next
+     * page. Output written by a command binding all at once is
+     * not paged, as that would require buffering it in full.
+     * Defaults to 0, i.e. no paging. Call before BeginCliAsync().
+     * @param lines - usually the terminal height less one, 0 to disable
+     */
+    void SetPagerLines(uint16_t lines) { mPagerLines = lines; }
+
+    /**
+     * @return the total number of received bytes dropped due to
+     *         overload. May be called from any context.
+     */
+    uint32_t GetDroppedByteCount() const { return mRxDroppedBytes.load(); }
+
+    /**
+     * @return the total number of output bytes dropped because
+     *         the character device stopped accepting output while
+     *         the transmit and bulk rings were full, see
+     *         CMS_EMBEDDED_CLI_TX_STALL_RETRIES. May be called from
+     *         any context.
+     */
+    uint32_t GetDroppedOutputByteCount() const { return mTxDroppedBytes.load(); }
+
+    /**
+     * @return the total number of PrintAsync() and PrintStaticAsync()
+     *         texts dropped because no event or queue entry was
+     *         available. May be called from any context.
+     */
+    uint32_t GetDroppedPrintCount() const { return mDroppedPrints.load(); }
+
 private:
     enum InternalSignals {
         BEGIN_CLI_SIG = CMS_EMBEDDED_CLI_SIGNAL_RANGE_START,
         END_CLI_SIG,
         NEW_CLI_DATA_SIG,
         ADD_CLI_BINDING_SIG,
+        ADD_CLI_BINDING_TABLE_SIG,
+        TX_READY_SIG,
+        TX_RETRY_SIG,
+        PRINT_SIG,
         INTERNAL_MAX_SIG
     };
     static_assert(INTERNAL_MAX_SIG <= CMS_EMBEDDED_CLI_SIGNAL_RANGE_END,
@@ -115,26 +379,168 @@ private:
         cms::interfaces::CharacterDevice* mCharDevice;
     };
 
-    class NewDataEvent : public QP::QEvt {
-    public:
-       uint8_t mByte;
-    };
+    //bytes moved out of the receive ring at a time. The
+    //embedded-cli's rx buffer limits how many are handed over
+    //before processing.
+    static constexpr size_t RX_DRAIN_CHUNK_SIZE = 32;
+
+    //the doorbell is not posted unless the AO's queue has more
+    //free entries than this, leaving room for control events.
+    static constexpr uint_fast16_t RX_DOORBELL_QUEUE_MARGIN = 1;
+
+    //received input is left waiting in the receive ring while
+    //more than this much output is waiting in the transmit ring.
+    static constexpr size_t TX_INPUT_HOLD_LEVEL = CMS_EMBEDDED_CLI_TX_RING_SIZE / 2;
+
+    //print events are not allocated unless the pool has more free
+    //blocks than this, nor posted unless the AO's queue has more
+    //free entries than this, leaving room for the doorbells and
+    //control events.
+    static constexpr uint_fast16_t PRINT_EVENT_POOL_MARGIN = 1;
+    static constexpr uint_fast16_t PRINT_QUEUE_MARGIN = 2;
+
+    //the most bulk output printed above the edited line at once.
+    static constexpr size_t BULK_CHUNK_SIZE = 128;
+
+    //software flow control, used when the character
+    //device does not support flow control itself.
+    static constexpr uint8_t XON = 0x11;
+    static constexpr uint8_t XOFF = 0x13;
+
+    //shown once a page of command output is complete, and erased
+    //again by returning to the start of its line.
+    static constexpr const char* PAGER_PROMPT = "--More--";
+    static constexpr const char* PAGER_ERASE = "\r\x1B[K";
+
+    //Ctrl-C, ends paged output
+    static constexpr uint8_t ETX = 0x03;
 
     class AddCliBindingEvent : public QP::QEvt {
     public:
         CommandBinding mBinding;
     };
 
+    class AddCliBindingTableEvent : public QP::QEvt {
+    public:
+        CommandBindingTable mTable;
+    };
+
+    class PrintEvent : public QP::QEvt {
+    public:
+        const char* mText;
+    };
+
+    //a print event with room for its text, sized as a whole
+    //to match one of the application's event pools.
+    template <size_t EventSize>
+    class PrintTextEvent : public PrintEvent {
+    public:
+        static_assert(EventSize > sizeof(PrintEvent), "print event size is too small");
+        char mBuffer[EventSize - sizeof(PrintEvent)];
+    };
+
+    using SmallPrintEvent = PrintTextEvent<CMS_EMBEDDED_CLI_PRINT_SMALL_EVENT_SIZE>;
+    using MediumPrintEvent = PrintTextEvent<CMS_EMBEDDED_CLI_PRINT_MEDIUM_EVENT_SIZE>;
+    using LargePrintEvent = PrintTextEvent<CMS_EMBEDDED_CLI_PRINT_LARGE_EVENT_SIZE>;
+
+    template <class PrintTextEventType>
+    bool PostPrintText(const char* text, size_t length);
+    bool PostPrint(const PrintEvent* e);
+    void CountDroppedPrint();
+
     //Active Object States
     Q_STATE_DECL(initial);
     Q_STATE_DECL(inactive);
     Q_STATE_DECL(active);
 
+    void CompleteStep();
     static void CliWriteChar(EmbeddedCli *embeddedCli, char c);
+    static void WriteReady(void* userData);
+    bool PutOutput(uint8_t byte);
+    bool WaitForOutputRoom();
+    void FlushOutput();
+    void ReleaseBulkOutput();
+    void ProduceOutput();
+    bool HandlePagerKey();
+    void ShowPagerPrompt();
+    void WritePagerText(const char* text);
+    void ScheduleOutput();
+    size_t PendingOutput() const { return static_cast<uint16_t>(mTxHead - mTxTail); }
     static void NewByteReceived(void* userData, uint8_t byte);
+    static void NewBytesReceived(void* userData, const uint8_t* bytes, size_t length);
+    void ReceiveIntoRing(const uint8_t* bytes, size_t length);
+    void DrainReceivedBytes();
+    void UpdateReceiveFlowControl();
+    void SetReceiveFlowControl(cms::interfaces::CharacterDevice::FlowControl state);
 
     cms::interfaces::CharacterDevice* mCharacterDevice;
 
+    //received bytes, written by the character device callback
+    //and drained by the AO upon a NEW_CLI_DATA_SIG doorbell.
+    ByteRing<CMS_EMBEDDED_CLI_RX_RING_SIZE> mRxRing;
+
+    //true when no doorbell is outstanding, i.e. the next
+    //received bytes must post a NEW_CLI_DATA_SIG to the AO.
+    std::atomic<bool> mRxDoorbellArmed;
+
+    OverloadPolicy mOverloadPolicy;
+
+    //written only by the character device callback
+    std::atomic<uint32_t> mRxDroppedBytes;
+    std::atomic<uint16_t> mRxLossPosition;
+
+    //written only by the AO. The value of mRxDroppedBytes already
+    //accounted for by MARK_LINE_CORRUPT handling.
+    std::atomic<uint32_t> mRxDroppedBytesHandled;
+    bool mRxDiscardingLine;
+
+    //true while the remote sender has been asked to pause. Set
+    //by the character device callback, or the AO.
+    std::atomic<bool> mRxFlowStopped;
+    //true while an XOFF/XON refused by the device waits to be
+    //written, ahead of other output. Only accessed by the AO.
+    bool mRxFlowPending;
+    bool mRxFlowPendingStop;
+
+    //output not yet accepted by the character device. Only
+    //accessed by the AO. Indices are free running.
+    std::array<uint8_t, CMS_EMBEDDED_CLI_TX_RING_SIZE> mTxRing;
+    uint16_t mTxHead;
+    uint16_t mTxTail;
+    std::atomic<uint32_t> mTxDroppedBytes;
+
+    //written by any active object printing
+    std::atomic<uint32_t> mDroppedPrints;
+
+    //command output waiting for its share of the transmit ring
+    ByteRing<CMS_EMBEDDED_CLI_BULK_RING_SIZE> mBulkRing;
+    size_t mBulkOutputBudget;
+    //true while a line of command output is partially written
+    bool mCommandLineOpen;
+
+    //lines per page, 0 when not paging
+    uint16_t mPagerLines;
+    //lines of command output written since the page began
+    uint16_t mPageLineCount;
+    //true while the --More-- prompt waits for a key
+    bool mPagerWaiting;
+    //true from the first call of a paged command's producer until
+    //all of its output, including any held back, is released.
+    bool mPagedOutput;
+
+    //true while output is waiting for the character device, i.e.
+    //its write ready callback must post a TX_READY_SIG to the AO.
+    std::atomic<bool> mTxReadyArmed;
+    //set by the write ready callback when the TX_READY_SIG could
+    //not be posted, see CompleteStep().
+    std::atomic<bool> mTxReadyMissed;
+    //retries refused output, see CMS_EMBEDDED_CLI_TX_RETRY_TICKS
+    QP::QTimeEvt mTxRetryTimer;
+    bool mTxRetryPending;
+    //true once a command gave up waiting for the character device,
+    //until the device accepts output again.
+    bool mTxStalled;
+
     //avoid pulling in embedded-cli header dependencies
     //this also in-theory allows for multiple CLI AO instances
     //an internal static_assert protects against future size changes
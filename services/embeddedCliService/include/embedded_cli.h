@@ -59,10 +59,22 @@ extern "C" {
   (((bytes) + CLI_UINT_SIZE - 1)/CLI_UINT_SIZE)
 
 typedef struct CliCommand CliCommand;
+typedef struct CliToken CliToken;
 typedef struct CliCommandBinding CliCommandBinding;
+typedef struct CliBindingTable CliBindingTable;
+typedef struct CliBindingHash CliBindingHash;
 typedef struct EmbeddedCli EmbeddedCli;
 typedef struct EmbeddedCliConfig EmbeddedCliConfig;
 
+/**
+ * Function producing next part of command output, e.g. a single line.
+ * See embeddedCliSetOutputProducer.
+ * @param cli - pointer to cli that is calling this producer
+ * @param context - as provided to embeddedCliSetOutputProducer
+ * @return true if more output is left to produce
+ */
+typedef bool (*CliOutputProducer)(EmbeddedCli *cli, void *context);
+
 
 struct CliCommand {
     /**
@@ -80,6 +92,21 @@ struct CliCommand {
     char *args;
 };
 
+/**
+ * Single token of tokenized args, see embeddedCliTokenizeArgsIndexed
+ */
+struct CliToken {
+    /**
+     * Null-terminated token within tokenized args
+     */
+    const char *str;
+
+    /**
+     * Length of token
+     */
+    uint16_t len;
+};
+
 /**
  * Struct to describe binding of command to function and
  */
@@ -115,6 +142,73 @@ struct CliCommandBinding {
      * @param context
      */
     void (*binding)(EmbeddedCli *cli, char *args, void *context);
+
+    /**
+     * Optional table of subcommands, which makes this binding a group of
+     * commands, e.g. "net" with "if" and "ping". When args start with name of
+     * a subcommand, that subcommand is called with the rest of args instead.
+     * Subcommands can have subcommands of their own. If binding function of a
+     * group is NULL, group prints its subcommands.
+     * Can be NULL.
+     */
+    const CliBindingTable *subcommands;
+};
+
+/**
+ * Perfect hash over names of bindings in a binding table, so binding can be
+ * found with a single string compare. Usually generated at compile time.
+ * For a given name:
+ * <ul>
+ * <li>h = 32-bit FNV-1a hash of name, starting from seed instead of the
+ *     usual offset basis</li>
+ * <li>g = h * 0x9E3779B1 (modulo 2^32)</li>
+ * <li>d = displacements[h % bucketCount]</li>
+ * <li>slot = ((g >> 16) + d * ((g & 0xFFFF) | 1)) % slotCount</li>
+ * </ul>
+ * slots[slot] is index of the only binding that can have this name.
+ */
+struct CliBindingHash {
+    /**
+     * Index of binding for each slot or 0xFFFF if slot is empty
+     */
+    const uint16_t *slots;
+
+    /**
+     * Displacement for each bucket
+     */
+    const uint16_t *displacements;
+
+    /**
+     * Number of slots. Must be a power of two
+     */
+    uint16_t slotCount;
+
+    /**
+     * Number of buckets
+     */
+    uint16_t bucketCount;
+
+    uint32_t seed;
+};
+
+/**
+ * Table of bindings that is referenced by cli instead of being copied to
+ * list of bindings, so it can be kept in read-only memory.
+ */
+struct CliBindingTable {
+    /**
+     * Bindings, preferably sorted by name. Bindings which are not sorted
+     * are searched linearly. Names must be unique
+     */
+    const CliCommandBinding *bindings;
+
+    uint16_t count;
+
+    /**
+     * Optional perfect hash over names of bindings. If NULL, bindings are
+     * found with binary search.
+     */
+    const CliBindingHash *hash;
 };
 
 struct EmbeddedCli {
@@ -197,6 +291,19 @@ struct EmbeddedCliConfig {
      * complete current command manually.
      */
     bool enableAutoComplete;
+
+    /**
+     * Maximum amount of binding tables that can be added via addBindingTable
+     * function.
+     */
+    uint16_t maxBindingTableCount;
+
+    /**
+     * Whether cursor should be moved with the shortest possible output:
+     * backspace to move left and echo of the char under the cursor to move
+     * right, instead of escape sequences. Useful on slow links.
+     */
+    bool enableShortCursorMoves;
 };
 
 /**
@@ -212,7 +319,9 @@ struct EmbeddedCliConfig {
  * <li>cliBuffer = NULL (use dynamic allocation)</li>
  * <li>cliBufferSize = 0</li>
  * <li>maxBindingCount = 8</li>
+ * <li>maxBindingTableCount = 2</li>
  * <li>enableAutoComplete = true</li>
+ * <li>enableShortCursorMoves = false</li>
  * </ul>
  * @return configuration for cli creation
  */
@@ -260,6 +369,14 @@ void embeddedCliReceiveChar(EmbeddedCli *cli, char c);
  */
 void embeddedCliProcess(EmbeddedCli *cli);
 
+/**
+ * Discard current command (entered but not yet submitted). Nothing is printed,
+ * so already echoed characters remain on screen. Useful when part of the
+ * input was lost and the remainder of the line should not be executed.
+ * @param cli
+ */
+void embeddedCliDiscardCommand(EmbeddedCli *cli);
+
 /**
  * Add specified binding to list of bindings. If list is already full, binding
  * is not added and false is returned
@@ -269,6 +386,17 @@ void embeddedCliProcess(EmbeddedCli *cli);
  */
 bool embeddedCliAddBinding(EmbeddedCli *cli, CliCommandBinding binding);
 
+/**
+ * Add specified table of bindings. Table itself is copied, but its bindings
+ * are not and must stay valid while cli is used. If a binding with the same
+ * name was added before, it takes precedence. If there is no space left for
+ * another table, table is not added and false is returned
+ * @param cli
+ * @param table
+ * @return true if table was added, false otherwise
+ */
+bool embeddedCliAddBindingTable(EmbeddedCli *cli, const CliBindingTable *table);
+
 /**
  * Print specified string and account for currently entered but not submitted
  * command.
@@ -279,6 +407,76 @@ bool embeddedCliAddBinding(EmbeddedCli *cli, CliCommandBinding binding);
  */
 void embeddedCliPrint(EmbeddedCli *cli, const char *string);
 
+/**
+ * Same as embeddedCliPrint, but string is written by caller char by char
+ * with cli->writeChar between this call and embeddedCliPrintEnd, so it can be
+ * produced while printed (e.g. formatted) without a buffer.
+ * Current command is deleted from screen.
+ * @param cli
+ */
+void embeddedCliPrintBegin(EmbeddedCli *cli);
+
+/**
+ * Ends printing started by embeddedCliPrintBegin. New line is printed and
+ * then current command is printed again.
+ * @param cli
+ */
+void embeddedCliPrintEnd(EmbeddedCli *cli);
+
+/**
+ * Same as embeddedCliPrintEnd, but no new line is printed, for text which
+ * already ends with its own line break and must be written unchanged.
+ * Current command is printed again right after the text.
+ * @param cli
+ */
+void embeddedCliPrintEndRaw(EmbeddedCli *cli);
+
+/**
+ * Returns true while a command binding (or onCommand callback) is executed,
+ * so chars written now are output of the command rather than echo of input,
+ * prompt or other redraws of current line. Output of command is always
+ * written on a new line, before invitation is printed again.
+ * @param cli
+ * @return
+ */
+bool embeddedCliIsCommandRunning(EmbeddedCli *cli);
+
+/**
+ * Called from a command binding (or onCommand callback) to produce the rest
+ * of its output lazily, instead of all at once. After binding returns, the
+ * command keeps running: invitation is not printed and received chars are
+ * not processed until producer returns false (or output is cancelled).
+ * Producer is called by embeddedCliProduceOutput, so the app can produce
+ * output only as fast as it can be written.
+ * @param cli
+ * @param producer
+ * @param context - passed to producer as is
+ * @return false if no command is running, producer is not used then
+ */
+bool embeddedCliSetOutputProducer(EmbeddedCli *cli, CliOutputProducer producer, void *context);
+
+/**
+ * Returns true while output producer of a command is set
+ * @param cli
+ * @return
+ */
+bool embeddedCliIsOutputPending(EmbeddedCli *cli);
+
+/**
+ * Calls output producer of running command once. When it has nothing more
+ * to produce, command is finished and invitation is printed.
+ * @param cli
+ * @return true if more output is left to produce
+ */
+bool embeddedCliProduceOutput(EmbeddedCli *cli);
+
+/**
+ * Finishes running command without producing the rest of its output and
+ * prints invitation. Does nothing if no output is pending.
+ * @param cli
+ */
+void embeddedCliCancelOutput(EmbeddedCli *cli);
+
 /**
  * Free allocated for cli memory
  * @param cli
@@ -300,7 +498,21 @@ void embeddedCliFree(EmbeddedCli *cli);
 void embeddedCliTokenizeArgs(char *args);
 
 /**
- * Return specific token from tokenized string
+ * Same as embeddedCliTokenizeArgs, but also fills an index of tokens, so
+ * each of them can be accessed directly instead of with embeddedCliGetToken,
+ * which scans tokenized string from its start on each call.
+ * Only first maxTokens tokens are indexed.
+ * @param args - string to tokenize (must have extra writable char after 0x00)
+ * @param tokens - index to fill, can be NULL if maxTokens is 0
+ * @param maxTokens - size of index
+ * @return total number of tokens, which is greater than maxTokens if not all
+ * of them were indexed
+ */
+uint16_t embeddedCliTokenizeArgsIndexed(char *args, CliToken *tokens, uint16_t maxTokens);
+
+/**
+ * Return specific token from tokenized string. String is scanned from its
+ * start, so to access all tokens use embeddedCliTokenizeArgsIndexed instead
  * @param tokenizedStr
  * @param pos (counted from 1)
  * @return token
@@ -347,7 +559,6 @@ extern "C" {
 #endif
 #include <stdlib.h>
 #include <string.h>
-#include <stdio.h>
 
 
 #define CLI_TOKEN_NPOS 0xffff
@@ -365,12 +576,6 @@ extern "C" {
 
 #define UNSET_U8FLAG(flags, flag) ((flags) &= (uint8_t) ~(flag))
 
-/**
- * Marks binding as candidate for autocompletion
- * This flag is updated each time getAutocompletedCommand is called
- */
-#define BINDING_FLAG_AUTOCOMPLETE 1u
-
 /**
  * Indicates that rx buffer overflow happened. In such case last command
  * that wasn't finished (no \r or \n were received) will be discarded
@@ -405,6 +610,11 @@ extern "C" {
  */
 #define CLI_FLAG_AUTOCOMPLETE_ENABLED 0x20u
 
+/**
+ * Indicates that cursor is moved with the shortest possible output
+ */
+#define CLI_FLAG_SHORT_CURSOR_MOVES 0x40u
+
 /**
 * Indicates that cursor direction should be forward
 */
@@ -419,6 +629,8 @@ typedef struct EmbeddedCliImpl EmbeddedCliImpl;
 typedef struct AutocompletedCommand AutocompletedCommand;
 typedef struct FifoBuf FifoBuf;
 typedef struct CliHistory CliHistory;
+typedef struct BindingCursor BindingCursor;
+typedef struct BindingTableRef BindingTableRef;
 
 struct FifoBuf {
     char *buf;
@@ -461,6 +673,42 @@ struct CliHistory {
     uint16_t itemsCount;
 };
 
+struct BindingTableRef {
+    /**
+     * Copy of added table
+     */
+    CliBindingTable table;
+
+    /**
+     * Whether bindings of table are sorted by name. If not, they are
+     * searched linearly
+     */
+    bool sorted;
+};
+
+/**
+ * Position while iterating over bindings from all sources in order of their
+ * names. Bindings with equal names are ordered by source and then by index.
+ */
+struct BindingCursor {
+    /**
+     * Name of current binding. Iteration continues with names that are not
+     * less than this one.
+     */
+    const char *name;
+
+    /**
+     * Source of current binding: 0 is list of bindings and 1 and above are
+     * binding tables. -1 if there is no current binding yet.
+     */
+    int source;
+
+    /**
+     * Index of current binding within its source
+     */
+    uint16_t index;
+};
+
 struct EmbeddedCliImpl {
     /**
      * Invitation string. Is printed at the beginning of each line with user
@@ -477,7 +725,13 @@ struct EmbeddedCliImpl {
     FifoBuf rxBuffer;
 
     /**
-     * Buffer for current command
+     * Buffer for current command, organized as a gap buffer. Part of
+     * command before the cursor is stored at the start of the buffer and
+     * part after the cursor is stored at the end of the buffer, both
+     * null-terminated, so editing at the cursor doesn't move the rest of
+     * the command. Last char of the buffer is always '\0'.
+     * When cursorPos is 0, buffer holds the whole command as a regular
+     * null-terminated string.
      */
     char *cmdBuffer;
 
@@ -491,23 +745,51 @@ struct EmbeddedCliImpl {
      */
     uint16_t cmdMaxSize;
 
+    /**
+     * Bindings are kept sorted by name, so bindings starting with
+     * a given prefix form a continuous range
+     */
     CliCommandBinding *bindings;
 
     /**
-     * Flags for each binding. Sizes are the same as for bindings array
+     * Length of name for each binding. Sizes are the same as for bindings array
      */
-    uint8_t *bindingsFlags;
+    uint8_t *bindingsNameLen;
 
     uint16_t bindingsCount;
 
     uint16_t maxBindingsCount;
 
+    /**
+     * Binding tables in order of addition. Their bindings are searched after
+     * bindings from the list above
+     */
+    BindingTableRef *bindingTables;
+
+    uint16_t bindingTablesCount;
+
+    uint16_t maxBindingTablesCount;
+
     /**
      * Total length of input line. This doesn't include invitation but
      * includes current command and its live autocompletion
      */
     uint16_t inputLineLength;
 
+    /**
+     * Name shown as live autocompletion. Together with the command it is a
+     * model of the input line on screen: chars of input line from cmdSize to
+     * inputLineLength are chars of this name at the same positions. NULL if
+     * those chars are unknown, then they are always redrawn.
+     */
+    const char *liveAutocompletion;
+
+    /**
+     * Position of first char of liveAutocompletion within input line. It is
+     * not 0 when a subcommand is autocompleted
+     */
+    uint16_t liveAutocompletionStart;
+
     /**
      * Stores last character that was processed.
      */
@@ -523,6 +805,31 @@ struct EmbeddedCliImpl {
      * 0 = end of command
      */
     uint16_t cursorPos;
+
+    /**
+     * Range of bindings [autocompleteFirst, autocompleteEnd) starting with
+     * first autocompleteLen chars of current command. Updated each time
+     * getAutocompletedCommand is called. While current command only grows
+     * at the end, next call needs to search only within this range.
+     * autocompleteLen is 0 if range must be searched for among all
+     * bindings (after command is changed other than by appending chars)
+     */
+    uint16_t autocompleteLen;
+    uint16_t autocompleteFirst;
+    uint16_t autocompleteEnd;
+
+    /**
+     * Producer of the rest of output of running command. NULL if command
+     * has no pending output (or no command is running).
+     */
+    CliOutputProducer outputProducer;
+
+    void *outputProducerContext;
+
+    /**
+     * Position of help listing, which is produced a binding at a time
+     */
+    BindingCursor helpCursor;
 };
 
 struct AutocompletedCommand {
@@ -538,6 +845,7 @@ struct AutocompletedCommand {
      * are two possible commands "get-led" and "get-adc", then for prefix "g"
      * autocompletedLen will be 4. If there are only one candidate, this number
      * is always equal to length of the command.
+     * Counted from start of firstCandidate, which is at wordStart in command.
      */
     uint16_t autocompletedLen;
 
@@ -545,6 +853,17 @@ struct AutocompletedCommand {
      * Total number of candidates for autocompletion
      */
     uint16_t candidateCount;
+
+    /**
+     * Position of autocompleted word within current command. 0 for command
+     * names and position of last word for subcommands
+     */
+    uint16_t wordStart;
+
+    /**
+     * Subcommands which contain candidates, or NULL for command names
+     */
+    const CliBindingTable *group;
 };
 
 static EmbeddedCliConfig defaultConfig;
@@ -555,30 +874,41 @@ static EmbeddedCliConfig defaultConfig;
  */
 static const uint16_t cliInternalBindingCount = 1;
 
-static const char *lineBreak = "\r\n";
+static const char lineBreak[] = "\r\n";
 
 /* References for VT100 escape sequences: 
  * https://learn.microsoft.com/en-us/windows/console/console-virtual-terminal-sequences 
  * https://ecma-international.org/publications-and-standards/standards/ecma-48/
+ * Sequences are const arrays, not pointers, so they take no RAM. Sequences
+ * with a count are formatted by moveCursor, without printf.
  */
 
 /** Escape sequence - Cursor forward (right) */
-static const char *escSeqCursorRight = "\x1B[C";
+static const char escSeqCursorRight[] = "\x1B[C";
 
 /** Escape sequence - Cursor backward (left) */
-static const char *escSeqCursorLeft = "\x1B[D";
+static const char escSeqCursorLeft[] = "\x1B[D";
 
 /** Escape sequence - Cursor save position */
-static const char *escSeqCursorSave = "\x1B[s";
+static const char escSeqCursorSave[] = "\x1B[s";
 
 /** Escape sequence - Cursor restore position */
-static const char *escSeqCursorRestore = "\x1B[u";
+static const char escSeqCursorRestore[] = "\x1B[u";
 
 /** Escape sequence - Cursor insert character (ICH) */
-static const char *escSeqInsertChar = "\x1B[@";
+static const char escSeqInsertChar[] = "\x1B[@";
 
 /** Escape sequence - Cursor delete character (DCH) */
-static const char *escSeqDeleteChar = "\x1B[P";
+static const char escSeqDeleteChar[] = "\x1B[P";
+
+/** Escape sequence - Erase from cursor to end of line (EL) */
+static const char escSeqEraseLine[] = "\x1B[K";
+
+/** Control sequence introducer, starts sequences with a count */
+static const char escSeqIntroducer[] = "\x1B[";
+
+/** Erase char before cursor when nothing follows it on the line */
+static const char eraseLastChar[] = "\b \b";
 
 /**
  * Navigate through command history back and forth. If navigateUp is true,
@@ -605,6 +935,16 @@ static void onEscapedInput(EmbeddedCli *cli, char c);
  */
 static void onCharInput(EmbeddedCli *cli, char c);
 
+/**
+ * Paste fast path. If rx buffer starts with a complete line of displayable
+ * characters, the characters are appended to current command and echoed at
+ * once, instead of one character at a time. Live autocompletion is not
+ * printed. The line ending is left in rx buffer for regular processing.
+ * @param cli
+ * @return true if a line was ingested, false otherwise
+ */
+static bool onPastedLine(EmbeddedCli *cli);
+
 /**
  * Process control character (like \r or \n) possibly altering state of current
  * command or executing onCommand callback.
@@ -623,163 +963,408 @@ static void parseCommand(EmbeddedCli *cli);
  * Print help for given binding (if it is set)
  * @param binding
  */
-static void printBindingHelp(EmbeddedCli *cli, CliCommandBinding *binding);
+static void printBindingHelp(EmbeddedCli *cli, const CliCommandBinding *binding);
 
 /**
- * Setup bindings for internal commands, like help
+ * Print names of subcommands of given group, in order of names
  * @param cli
+ * @param group
  */
-static void initInternalBindings(EmbeddedCli *cli);
+static void printSubcommands(EmbeddedCli *cli, const CliBindingTable *group);
 
 /**
- * Show help for given tokens (or default help if no tokens)
+ * Find binding with given name in list of bindings and then in binding tables
  * @param cli
- * @param tokens
- * @param context - not used
+ * @param name
+ * @return binding or NULL if not found
  */
-static void onHelp(EmbeddedCli *cli, char *tokens, void *context);
+static const CliCommandBinding *findBinding(EmbeddedCli *cli, const char *name);
 
 /**
- * Show error about unknown command
- * @param cli
+ * Find binding with given name in binding table using its perfect hash
+ * @param table - table with hash
  * @param name
+ * @return binding or NULL if not found
  */
-static void onUnknownCommand(EmbeddedCli *cli, const char *name);
+static const CliCommandBinding *findHashedBinding(const CliBindingTable *table, const char *name);
 
 /**
- * Return autocompleted command for given prefix.
- * Prefix is compared to all known command bindings and autocompleted result
- * is returned
- * @param cli
- * @param prefix
- * @return
+ * Find binding with given name in binding table. Table is searched with its
+ * perfect hash if it has one, otherwise linearly, since subcommand tables are
+ * usually small
+ * @param table
+ * @param name
+ * @return binding or NULL if not found
  */
-static AutocompletedCommand getAutocompletedCommand(EmbeddedCli *cli, const char *prefix);
+static const CliCommandBinding *findTableBinding(const CliBindingTable *table, const char *name);
 
 /**
- * Prints autocompletion result while keeping current command unchanged
- * Prints only if autocompletion is present and only one candidate exists.
- * @param cli
+ * Find subcommand named by first word of args. If found, name is separated
+ * from the rest of args, like command name is separated from args
+ * @param group - subcommands of a binding
+ * @param args - args of group, set to args of subcommand if it is found
+ * @return subcommand or NULL if args don't start with its name
  */
-static void printLiveAutocompletion(EmbeddedCli *cli);
+static const CliCommandBinding *findSubcommand(const CliBindingTable *group, char **args);
 
 /**
- * Handles autocomplete request. If autocomplete possible - fills current
- * command with autocompleted command. When multiple commands satisfy entered
- * prefix, they are printed to output.
- * @param cli
+ * Return index of first binding with name not less (or greater, if upper is
+ * true) than given one
+ * @param bindings - bindings sorted by name
+ * @param count
+ * @param name
+ * @param upper
+ * @return index of binding or count if there is no such binding
  */
-static void onAutocompleteRequest(EmbeddedCli *cli);
+static uint16_t findBindingBound(const CliCommandBinding *bindings, uint16_t count,
+                                 const char *name, bool upper);
 
 /**
- * Removes all input from current line (replaces it with whitespaces)
- * And places cursor at the beginning of the line
+ * Return bindings of given source (0 is list of bindings, 1 and above are
+ * binding tables)
  * @param cli
+ * @param source
+ * @param count - number of bindings in source
+ * @return bindings or NULL if there is no such source
  */
-static void clearCurrentLine(EmbeddedCli *cli);
+static const CliCommandBinding *getBindingSource(EmbeddedCli *cli, int source, uint16_t *count);
 
 /**
- * Write given string to cli output
+ * Returns true if bindings of given source are sorted by name, so they can
+ * be searched with binary search
  * @param cli
- * @param str
+ * @param source - 0 for list of bindings, 1 and above for binding tables
+ * @return
  */
-static void writeToOutput(EmbeddedCli *cli, const char *str);
+static bool isBindingSourceSorted(EmbeddedCli *cli, int source);
 
 /**
- * Move cursor forward (right) by given number of positions
- * @param cli
+ * Linear search for the first binding after cursor in source, which is not
+ * sorted by name
+ * @param bindings
  * @param count
- * @param direction: true = forward (right), false = backward (left)
+ * @param cursor
+ * @param source - index of source of bindings
+ * @return index of found binding or count if there is none
  */
-static void moveCursor(EmbeddedCli* cli, uint16_t count, bool direction);
+static uint16_t findNextUnsortedBinding(const CliCommandBinding *bindings, uint16_t count,
+                                        const BindingCursor *cursor, int source);
 
 /**
- * Returns true if provided char is a supported control char:
- * \r, \n, \b or 0x7F (treated as \b)
- * @param c
- * @return
+ * Move cursor to next binding in order of names across all sources
+ * @param cli
+ * @param cursor
+ * @return next binding or NULL if there are no more bindings
  */
-static bool isControlChar(char c);
+static const CliCommandBinding *nextBinding(EmbeddedCli *cli, BindingCursor *cursor);
 
 /**
- * Returns true if provided char is a valid displayable character:
- * a-z, A-Z, 0-9, whitespace, punctuation, etc.
- * Currently only ASCII is supported
- * @param c
- * @return
+ * Move cursor to next binding of group in order of names
+ * @param group - subcommands of a binding
+ * @param cursor
+ * @return next binding or NULL if there are no more bindings
  */
-static bool isDisplayableChar(char c);
+static const CliCommandBinding *nextGroupBinding(const CliBindingTable *group, BindingCursor *cursor);
 
 /**
- * How many elements are currently available in buffer
- * @param buffer
- * @return number of elements
+ * Narrow range of bindings to bindings starting with first prefixLen chars
+ * of current command
+ * @param cli
+ * @param bindings - bindings sorted by name
+ * @param first - first binding of range
+ * @param end - end of range
+ * @param from - index of first char to compare (previous chars are known to be equal)
+ * @param prefixLen
  */
-static uint16_t fifoBufAvailable(FifoBuf *buffer);
+static void findCandidates(EmbeddedCli *cli, const CliCommandBinding *bindings,
+                           uint16_t *first, uint16_t *end, size_t from, size_t prefixLen);
 
 /**
- * Return first character from buffer and remove it from buffer
- * Buffer must be non-empty, otherwise 0 is returned
- * @param buffer
- * @return
+ * Compare first chars of binding name with current command
+ * @param cli
+ * @param name - binding name
+ * @param from - index of first char to compare (previous chars are known to be equal)
+ * @param len - number of chars of current command to compare
+ * @return <0, 0 or >0 if name is less, equal or greater than the command prefix
  */
-static char fifoBufPop(FifoBuf *buffer);
+static int compareToCommand(EmbeddedCli *cli, const char *name, size_t from, size_t len);
 
 /**
- * Push character into fifo buffer. If there is no space left, character is
- * discarded and false is returned
- * @param buffer
- * @param a - character to add
- * @return true if char was added to buffer, false otherwise
+ * Compare first chars of binding name with a word of current command
+ * @param cli
+ * @param name - binding name
+ * @param wordStart - index of first char of word in current command
+ * @param len - number of chars of word to compare
+ * @return <0, 0 or >0 if name is less, equal or greater than the word prefix
  */
-static bool fifoBufPush(FifoBuf *buffer, char a);
+static int compareToCommandWord(EmbeddedCli *cli, const char *name, uint16_t wordStart, size_t len);
 
 /**
- * Copy provided string to the history buffer.
- * If it is already inside history, it will be removed from it and added again.
- * So after addition, it will always be on top
- * If available size is not enough (and total size is enough) old elements will
- * be removed from history so this item can be put to it
- * @param history
- * @param str
- * @return true if string was put in history
+ * Returns char of current command at given index (command is stored in
+ * two parts)
+ * @param cli
+ * @param i
+ * @return
  */
-static bool historyPut(CliHistory *history, const char *str);
+static char getCommandChar(EmbeddedCli *cli, uint16_t i);
 
 /**
- * Get item from history. Items are counted from 1 so if item is 0 or greater
- * than itemCount, NULL is returned
- * @param history
- * @param item
- * @return true if string was put in history
+ * Find binding named by a word of current command
+ * @param cli
+ * @param group - subcommands to search, or NULL to search command names
+ * (then word must start the command)
+ * @param wordStart - index of first char of word in current command
+ * @param wordLen
+ * @return binding or NULL if not found
  */
-static const char *historyGet(CliHistory *history, uint16_t item);
+static const CliCommandBinding *findCommandWord(EmbeddedCli *cli, const CliBindingTable *group,
+                                                uint16_t wordStart, uint16_t wordLen);
 
 /**
- * Remove specific item from history
- * @param history
- * @param str - string to remove
- * @return
+ * Find group of subcommands which last word of current command belongs to.
+ * For example, for "net if sh" it is subcommands of "if" from subcommands of
+ * "net". Words must be separated by a single space
+ * @param cli
+ * @param group - found group or NULL if last word is command name or if
+ * previous words don't name nested groups
+ * @return index of first char of last word
  */
-static void historyRemove(CliHistory *history, const char *str);
+static uint16_t findSubcommandGroup(EmbeddedCli *cli, const CliBindingTable **group);
 
 /**
- * Return position (index of first char) of specified token
- * @param tokenizedStr - tokenized string (separated by \0 with
- * \0\0 at the end)
- * @param pos - token position (counted from 1)
- * @return index of first char of specified token
+ * Add bindings starting with last word of current command to autocompletion
+ * candidates. Each binding is compared, so bindings don't have to be sorted
+ * @param cli
+ * @param cmd - candidates found so far
+ * @param bindings
+ * @param count
  */
-static uint16_t getTokenPosition(const char *tokenizedStr, uint16_t pos);
+static void addUnsortedCandidates(EmbeddedCli *cli, AutocompletedCommand *cmd,
+                                  const CliCommandBinding *bindings, uint16_t count);
 
-EmbeddedCliConfig *embeddedCliDefaultConfig(void) {
-    defaultConfig.rxBufferSize = 64;
-    defaultConfig.cmdBufferSize = 64;
-    defaultConfig.historyBufferSize = 128;
+/**
+ * Setup bindings for internal commands, like help
+ * @param cli
+ */
+static void initInternalBindings(EmbeddedCli *cli);
+
+/**
+ * Show help for given tokens (or default help if no tokens). Tokens after the
+ * first one name subcommands, e.g. "help net if"
+ * @param cli
+ * @param tokens
+ * @param context - not used
+ */
+static void onHelp(EmbeddedCli *cli, char *tokens, void *context);
+
+/**
+ * Produces help listing (after "help" without arguments) a binding at a time
+ * @param cli
+ * @param context - not used
+ * @return true if more bindings are left
+ */
+static bool produceHelpListing(EmbeddedCli *cli, void *context);
+
+/**
+ * Finishes command which has pending output and prints invitation
+ * @param cli
+ */
+static void finishPendingOutput(EmbeddedCli *cli);
+
+/**
+ * Show error about unknown command
+ * @param cli
+ * @param name
+ */
+static void onUnknownCommand(EmbeddedCli *cli, const char *name);
+
+/**
+ * Show error about unknown subcommand of a group, and list its subcommands
+ * @param cli
+ * @param group - subcommands of a binding
+ * @param name
+ */
+static void onUnknownSubcommand(EmbeddedCli *cli, const CliBindingTable *group, const char *name);
+
+/**
+ * Return autocompleted command for current command.
+ * Current command is compared to all known command bindings and autocompleted
+ * result is returned
+ * @param cli
+ * @return
+ */
+static AutocompletedCommand getAutocompletedCommand(EmbeddedCli *cli);
+
+/**
+ * Prints autocompletion result while keeping current command unchanged
+ * Prints only if autocompletion is present and only one candidate exists.
+ * @param cli
+ */
+static void printLiveAutocompletion(EmbeddedCli *cli);
+
+/**
+ * Prints live autocompletion if it was deferred, and clears the pending flag.
+ * @param cli
+ * @param pending - true if live autocompletion is out of date
+ */
+static void flushLiveAutocompletion(EmbeddedCli *cli, bool *pending);
+
+/**
+ * Handles autocomplete request. If autocomplete possible - fills current
+ * command with autocompleted command. When multiple commands satisfy entered
+ * prefix, they are printed to output.
+ * @param cli
+ */
+static void onAutocompleteRequest(EmbeddedCli *cli);
+
+/**
+ * Removes all input from current line (erases it to the end of line)
+ * And places cursor at the beginning of the line
+ * @param cli
+ */
+static void clearCurrentLine(EmbeddedCli *cli);
+
+/**
+ * Changes input line on screen to given text. Only the part of the text after
+ * its common prefix with the line on screen is written, the rest of the line
+ * is erased. Cursor is left at the end of the text.
+ * @param cli
+ * @param cursorCol - position of cursor within input line
+ * @param shownCmdLen - number of chars at the start of cmdBuffer shown on
+ * screen as the command, cmdBuffer must not have a gap
+ * @param text
+ * @param len - length of text
+ */
+static void updateInputLine(EmbeddedCli *cli, uint16_t cursorCol, uint16_t shownCmdLen,
+                            const char *text, uint16_t len);
+
+/**
+ * Returns part of current command after the cursor (null-terminated)
+ * @param cli
+ * @return
+ */
+static char *getCommandTail(EmbeddedCli *cli);
+
+/**
+ * Moves part of current command after the cursor next to the part before
+ * it, so cmdBuffer holds the whole command as a regular null-terminated
+ * string. Cursor position is set to the end of command, but cursor on
+ * screen is not moved.
+ * @param cli
+ */
+static void joinCommand(EmbeddedCli *cli);
+
+/**
+ * Write given string to cli output
+ * @param cli
+ * @param str
+ */
+static void writeToOutput(EmbeddedCli *cli, const char *str);
+
+/**
+ * Write decimal digits of given value to cli output
+ * @param cli
+ * @param value
+ */
+static void writeDecimal(EmbeddedCli *cli, uint16_t value);
+
+/**
+ * Move cursor forward (right) by given number of positions
+ * @param cli
+ * @param count
+ * @param direction: true = forward (right), false = backward (left)
+ */
+static void moveCursor(EmbeddedCli* cli, uint16_t count, bool direction);
+
+/**
+ * Returns true if provided char is a supported control char:
+ * \r, \n, \b or 0x7F (treated as \b)
+ * @param c
+ * @return
+ */
+static bool isControlChar(char c);
+
+/**
+ * Returns true if provided char is a valid displayable character:
+ * a-z, A-Z, 0-9, whitespace, punctuation, etc.
+ * Currently only ASCII is supported
+ * @param c
+ * @return
+ */
+static bool isDisplayableChar(char c);
+
+/**
+ * How many elements are currently available in buffer
+ * @param buffer
+ * @return number of elements
+ */
+static uint16_t fifoBufAvailable(FifoBuf *buffer);
+
+/**
+ * Return first character from buffer and remove it from buffer
+ * Buffer must be non-empty, otherwise 0 is returned
+ * @param buffer
+ * @return
+ */
+static char fifoBufPop(FifoBuf *buffer);
+
+/**
+ * Push character into fifo buffer. If there is no space left, character is
+ * discarded and false is returned
+ * @param buffer
+ * @param a - character to add
+ * @return true if char was added to buffer, false otherwise
+ */
+static bool fifoBufPush(FifoBuf *buffer, char a);
+
+/**
+ * Copy provided string to the history buffer.
+ * If it is already inside history, it will be removed from it and added again.
+ * So after addition, it will always be on top
+ * If available size is not enough (and total size is enough) old elements will
+ * be removed from history so this item can be put to it
+ * @param history
+ * @param str
+ * @return true if string was put in history
+ */
+static bool historyPut(CliHistory *history, const char *str);
+
+/**
+ * Get item from history. Items are counted from 1 so if item is 0 or greater
+ * than itemCount, NULL is returned
+ * @param history
+ * @param item
+ * @return true if string was put in history
+ */
+static const char *historyGet(CliHistory *history, uint16_t item);
+
+/**
+ * Remove specific item from history
+ * @param history
+ * @param str - string to remove
+ * @return
+ */
+static void historyRemove(CliHistory *history, const char *str);
+
+/**
+ * Return position (index of first char) of specified token
+ * @param tokenizedStr - tokenized string (separated by \0 with
+ * \0\0 at the end)
+ * @param pos - token position (counted from 1)
+ * @return index of first char of specified token
+ */
+static uint16_t getTokenPosition(const char *tokenizedStr, uint16_t pos);
+
+EmbeddedCliConfig *embeddedCliDefaultConfig(void) {
+    defaultConfig.rxBufferSize = 64;
+    defaultConfig.cmdBufferSize = 64;
+    defaultConfig.historyBufferSize = 128;
     defaultConfig.cliBuffer = NULL;
     defaultConfig.cliBufferSize = 0;
     defaultConfig.maxBindingCount = 8;
+    defaultConfig.maxBindingTableCount = 2;
     defaultConfig.enableAutoComplete = true;
+    defaultConfig.enableShortCursorMoves = false;
     defaultConfig.invitation = "> ";
     return &defaultConfig;
 }
@@ -793,7 +1378,8 @@ uint16_t embeddedCliRequiredSize(EmbeddedCliConfig *config) {
             BYTES_TO_CLI_UINTS(config->cmdBufferSize * sizeof(char)) +
             BYTES_TO_CLI_UINTS(config->historyBufferSize * sizeof(char)) +
             BYTES_TO_CLI_UINTS(bindingCount * sizeof(CliCommandBinding)) +
-            BYTES_TO_CLI_UINTS(bindingCount * sizeof(uint8_t))));
+            BYTES_TO_CLI_UINTS(bindingCount * sizeof(uint8_t)) +
+            BYTES_TO_CLI_UINTS(config->maxBindingTableCount * sizeof(BindingTableRef))));
 }
 
 EmbeddedCli *embeddedCliNew(EmbeddedCliConfig *config) {
@@ -833,9 +1419,12 @@ EmbeddedCli *embeddedCliNew(EmbeddedCliConfig *config) {
     impl->bindings = (CliCommandBinding *) buf;
     buf += BYTES_TO_CLI_UINTS(bindingCount * sizeof(CliCommandBinding));
 
-    impl->bindingsFlags = (uint8_t *) buf;
+    impl->bindingsNameLen = (uint8_t *) buf;
     buf += BYTES_TO_CLI_UINTS(bindingCount);
 
+    impl->bindingTables = (BindingTableRef *) buf;
+    buf += BYTES_TO_CLI_UINTS(config->maxBindingTableCount * sizeof(BindingTableRef));
+
     impl->history.buf = (char *) buf;
     impl->history.bufferSize = config->historyBufferSize;
 
@@ -845,15 +1434,27 @@ EmbeddedCli *embeddedCliNew(EmbeddedCliConfig *config) {
     if (config->enableAutoComplete)
         SET_FLAG(impl->flags, CLI_FLAG_AUTOCOMPLETE_ENABLED);
 
+    if (config->enableShortCursorMoves)
+        SET_FLAG(impl->flags, CLI_FLAG_SHORT_CURSOR_MOVES);
+
     impl->rxBuffer.size = config->rxBufferSize;
     impl->rxBuffer.front = 0;
     impl->rxBuffer.back = 0;
     impl->cmdMaxSize = config->cmdBufferSize;
+    impl->cmdBuffer[impl->cmdMaxSize - 1] = '\0';
     impl->bindingsCount = 0;
     impl->maxBindingsCount = (uint16_t) (config->maxBindingCount + cliInternalBindingCount);
+    impl->bindingTablesCount = 0;
+    impl->maxBindingTablesCount = config->maxBindingTableCount;
     impl->lastChar = '\0';
     impl->invitation = config->invitation;
     impl->cursorPos = 0;
+    impl->autocompleteLen = 0;
+    impl->liveAutocompletion = NULL;
+    impl->liveAutocompletionStart = 0;
+    impl->outputProducer = NULL;
+    impl->outputProducerContext = NULL;
+    impl->helpCursor.source = -1;
 
     initInternalBindings(cli);
 
@@ -884,41 +1485,113 @@ void embeddedCliProcess(EmbeddedCli *cli) {
         writeToOutput(cli, impl->invitation);
     }
 
-    while (fifoBufAvailable(&impl->rxBuffer)) {
+    // live autocompletion is drawn once per run of typed characters
+    // instead of after each one. It must be on screen before any other
+    // input is handled, since that input may move or redraw the line.
+    bool autocompletePending = false;
+
+    // received chars wait until output of running command is produced
+    while (impl->outputProducer == NULL && fifoBufAvailable(&impl->rxBuffer)) {
+        if (onPastedLine(cli)) {
+            autocompletePending = true;
+            continue;
+        }
+
         char c = fifoBufPop(&impl->rxBuffer);
 
         if (IS_FLAG_SET(impl->flags, CLI_FLAG_ESCAPE_MODE)) {
+            flushLiveAutocompletion(cli, &autocompletePending);
             onEscapedInput(cli, c);
+            autocompletePending = true;
         } else if (impl->lastChar == 0x1B && c == '[') {
             //enter escape mode
             SET_FLAG(impl->flags, CLI_FLAG_ESCAPE_MODE);
         } else if (isControlChar(c)) {
+            flushLiveAutocompletion(cli, &autocompletePending);
             onControlInput(cli, c);
+            autocompletePending = true;
         } else if (isDisplayableChar(c)) {
             onCharInput(cli, c);
+            autocompletePending = true;
         }
 
-        printLiveAutocompletion(cli);
-
         impl->lastChar = c;
     }
 
+    // while output is pending, there is no input line on screen
+    if (impl->outputProducer == NULL)
+        flushLiveAutocompletion(cli, &autocompletePending);
+
     // discard unfinished command if overflow happened
     if (IS_FLAG_SET(impl->flags, CLI_FLAG_OVERFLOW)) {
         impl->cmdSize = 0;
         impl->cmdBuffer[impl->cmdSize] = '\0';
+        impl->cursorPos = 0;
+        impl->autocompleteLen = 0;
+        impl->liveAutocompletion = NULL;
         UNSET_U8FLAG(impl->flags, CLI_FLAG_OVERFLOW);
     }
 }
 
+void embeddedCliDiscardCommand(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+
+    impl->cmdSize = 0;
+    impl->cmdBuffer[impl->cmdSize] = '\0';
+    impl->cursorPos = 0;
+    impl->history.current = 0;
+    impl->autocompleteLen = 0;
+    impl->liveAutocompletion = NULL;
+}
+
 bool embeddedCliAddBinding(EmbeddedCli *cli, CliCommandBinding binding) {
     PREPARE_IMPL(cli);
     if (impl->bindingsCount == impl->maxBindingsCount)
         return false;
 
-    impl->bindings[impl->bindingsCount] = binding;
+    size_t nameLen = strlen(binding.name);
+    if (nameLen > UINT8_MAX)
+        return false;
+
+    // insert after bindings with the same or lesser name to keep bindings
+    // sorted (and keep order of addition for equal names)
+    uint16_t first = 0;
+    uint16_t end = impl->bindingsCount;
+    while (first < end) {
+        uint16_t mid = (uint16_t) (first + (end - first) / 2);
+        if (strcmp(impl->bindings[mid].name, binding.name) <= 0)
+            first = (uint16_t) (mid + 1);
+        else
+            end = mid;
+    }
+
+    uint16_t moved = (uint16_t) (impl->bindingsCount - first);
+    memmove(&impl->bindings[first + 1], &impl->bindings[first], moved * sizeof(CliCommandBinding));
+    memmove(&impl->bindingsNameLen[first + 1], &impl->bindingsNameLen[first], moved);
+    impl->bindings[first] = binding;
+    impl->bindingsNameLen[first] = (uint8_t) nameLen;
+
+    // keep help listing, if it is being produced, at the same binding
+    if (impl->helpCursor.source == 0 && first <= impl->helpCursor.index)
+        ++impl->helpCursor.index;
 
     ++impl->bindingsCount;
+    impl->autocompleteLen = 0;
+    return true;
+}
+
+bool embeddedCliAddBindingTable(EmbeddedCli *cli, const CliBindingTable *table) {
+    PREPARE_IMPL(cli);
+    if (impl->bindingTablesCount == impl->maxBindingTablesCount)
+        return false;
+
+    BindingTableRef *ref = &impl->bindingTables[impl->bindingTablesCount];
+    ref->table = *table;
+    ref->sorted = true;
+    for (uint16_t i = 1; i < table->count && ref->sorted; ++i) {
+        ref->sorted = strcmp(table->bindings[i - 1].name, table->bindings[i].name) <= 0;
+    }
+    ++impl->bindingTablesCount;
     return true;
 }
 
@@ -926,6 +1599,18 @@ void embeddedCliPrint(EmbeddedCli *cli, const char *string) {
     if (cli->writeChar == NULL)
         return;
 
+    embeddedCliPrintBegin(cli);
+
+    // print provided string
+    writeToOutput(cli, string);
+
+    embeddedCliPrintEnd(cli);
+}
+
+void embeddedCliPrintBegin(EmbeddedCli *cli) {
+    if (cli->writeChar == NULL)
+        return;
+
     PREPARE_IMPL(cli);
 
     // Save cursor position
@@ -937,15 +1622,27 @@ void embeddedCliPrint(EmbeddedCli *cli, const char *string) {
 
     // Restore cursor position
     impl->cursorPos = cursorPosSave;
+}
+
+void embeddedCliPrintEnd(EmbeddedCli *cli) {
+    if (cli->writeChar == NULL)
+        return;
 
-    // print provided string
-    writeToOutput(cli, string);
     writeToOutput(cli, lineBreak);
+    embeddedCliPrintEndRaw(cli);
+}
+
+void embeddedCliPrintEndRaw(EmbeddedCli *cli) {
+    if (cli->writeChar == NULL)
+        return;
+
+    PREPARE_IMPL(cli);
 
     // print current command back to screen
     if (!IS_FLAG_SET(impl->flags, CLI_FLAG_DIRECT_PRINT)) {
         writeToOutput(cli, impl->invitation);
         writeToOutput(cli, impl->cmdBuffer);
+        writeToOutput(cli, getCommandTail(cli));
         impl->inputLineLength = impl->cmdSize;
         moveCursor(cli, impl->cursorPos, CURSOR_DIRECTION_BACKWARD);
 
@@ -953,6 +1650,44 @@ void embeddedCliPrint(EmbeddedCli *cli, const char *string) {
     }
 }
 
+bool embeddedCliIsCommandRunning(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    return IS_FLAG_SET(impl->flags, CLI_FLAG_DIRECT_PRINT);
+}
+
+bool embeddedCliSetOutputProducer(EmbeddedCli *cli, CliOutputProducer producer, void *context) {
+    PREPARE_IMPL(cli);
+    if (!IS_FLAG_SET(impl->flags, CLI_FLAG_DIRECT_PRINT))
+        return false;
+
+    impl->outputProducer = producer;
+    impl->outputProducerContext = context;
+    return true;
+}
+
+bool embeddedCliIsOutputPending(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    return impl->outputProducer != NULL;
+}
+
+bool embeddedCliProduceOutput(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    if (impl->outputProducer == NULL)
+        return false;
+
+    if (impl->outputProducer(cli, impl->outputProducerContext))
+        return true;
+
+    finishPendingOutput(cli);
+    return false;
+}
+
+void embeddedCliCancelOutput(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    if (impl->outputProducer != NULL)
+        finishPendingOutput(cli);
+}
+
 void embeddedCliFree(EmbeddedCli *cli) {
     PREPARE_IMPL(cli);
     if (IS_FLAG_SET(impl->flags, CLI_FLAG_ALLOCATED)) {
@@ -962,8 +1697,12 @@ void embeddedCliFree(EmbeddedCli *cli) {
 }
 
 void embeddedCliTokenizeArgs(char *args) {
+    embeddedCliTokenizeArgsIndexed(args, NULL, 0);
+}
+
+uint16_t embeddedCliTokenizeArgsIndexed(char *args, CliToken *tokens, uint16_t maxTokens) {
     if (args == NULL)
-        return;
+        return 0;
 
     // for now only space, but can add more later
     const char *separators = " ";
@@ -973,6 +1712,8 @@ void embeddedCliTokenizeArgs(char *args) {
     // indicates that previous char was a slash, so next char is copied as is
     bool escapeActivated = false;
     int insertPos = 0;
+    int tokenStart = 0;
+    uint16_t tokenCount = 0;
 
     int i = 0;
     char currentChar;
@@ -993,14 +1734,34 @@ void embeddedCliTokenizeArgs(char *args) {
 
         // null chars are only copied once and not copied to the beginning
         if (currentChar != '\0' || (insertPos > 0 && args[insertPos - 1] != '\0')) {
+            // tokens are complete once copied, since later chars are copied after them
+            if (currentChar == '\0') {
+                if (tokenCount < maxTokens) {
+                    tokens[tokenCount].str = &args[tokenStart];
+                    tokens[tokenCount].len = (uint16_t) (insertPos - tokenStart);
+                }
+                ++tokenCount;
+            } else if (insertPos == 0 || args[insertPos - 1] == '\0') {
+                tokenStart = insertPos;
+            }
             args[insertPos] = currentChar;
             ++insertPos;
         }
     }
 
+    // last token is not followed by a separator
+    if (insertPos > 0 && args[insertPos - 1] != '\0') {
+        if (tokenCount < maxTokens) {
+            tokens[tokenCount].str = &args[tokenStart];
+            tokens[tokenCount].len = (uint16_t) (insertPos - tokenStart);
+        }
+        ++tokenCount;
+    }
+
     // make args double null-terminated source buffer must be big enough to contain extra spaces
     args[insertPos] = '\0';
     args[insertPos + 1] = '\0';
+    return tokenCount;
 }
 
 const char *embeddedCliGetToken(const char *tokenizedStr, uint16_t pos) {
@@ -1059,10 +1820,6 @@ static void navigateHistory(EmbeddedCli *cli, bool navigateUp) {
         (!navigateUp && impl->history.current == 0))
         return;
 
-    clearCurrentLine(cli);
-
-    writeToOutput(cli, impl->invitation);
-
     if (navigateUp)
         ++impl->history.current;
     else
@@ -1073,13 +1830,16 @@ static void navigateHistory(EmbeddedCli *cli, bool navigateUp) {
     if (item == NULL)
         item = "";
     uint16_t len = (uint16_t) strlen(item);
+
+    // history items often share a prefix, so only the rest is redrawn
+    uint16_t cursorCol = (uint16_t) (impl->cmdSize - impl->cursorPos);
+    joinCommand(cli);
+    updateInputLine(cli, cursorCol, impl->cmdSize, item, len);
+
     memcpy(impl->cmdBuffer, item, len);
     impl->cmdBuffer[len] = '\0';
     impl->cmdSize = len;
-
-    writeToOutput(cli, impl->cmdBuffer);
-    impl->inputLineLength = impl->cmdSize;
-    impl->cursorPos = 0;
+    impl->autocompleteLen = 0;
 
     printLiveAutocompletion(cli);
 }
@@ -1098,13 +1858,24 @@ static void onEscapedInput(EmbeddedCli *cli, char c) {
         }
 
         if (c == 'C' && impl->cursorPos > 0) {
+            // move first char after the cursor to the end of first part
+            uint16_t headLen = (uint16_t) (impl->cmdSize - impl->cursorPos);
+            impl->cmdBuffer[headLen] = *getCommandTail(cli);
+            impl->cmdBuffer[headLen + 1] = '\0';
             impl->cursorPos--;
-            writeToOutput(cli, escSeqCursorRight);
+            if (IS_FLAG_SET(impl->flags, CLI_FLAG_SHORT_CURSOR_MOVES))
+                cli->writeChar(cli, impl->cmdBuffer[headLen]); // same char is printed again
+            else
+                writeToOutput(cli, escSeqCursorRight);
         }
 
-        if (c == 'D' && impl->cursorPos < strlen(impl->cmdBuffer)) {
+        if (c == 'D' && impl->cursorPos < impl->cmdSize) {
+            // move last char before the cursor to the start of second part
+            uint16_t headLen = (uint16_t) (impl->cmdSize - impl->cursorPos);
             impl->cursorPos++;
-            writeToOutput(cli, escSeqCursorLeft);
+            *getCommandTail(cli) = impl->cmdBuffer[headLen - 1];
+            impl->cmdBuffer[headLen - 1] = '\0';
+            moveCursor(cli, 1, CURSOR_DIRECTION_BACKWARD);
         }
     }
 }
@@ -1116,20 +1887,69 @@ static void onCharInput(EmbeddedCli *cli, char c) {
     if (impl->cmdSize + 2 >= impl->cmdMaxSize)
         return;
 
-    size_t insertPos = strlen(impl->cmdBuffer) - impl->cursorPos;
-
-    memmove(&impl->cmdBuffer[insertPos + 1], &impl->cmdBuffer[insertPos], impl->cursorPos + 1);
+    size_t insertPos = impl->cmdSize - impl->cursorPos;
 
-    ++impl->cmdSize;
-    ++impl->inputLineLength;
     impl->cmdBuffer[insertPos] = c;
+    impl->cmdBuffer[insertPos + 1] = '\0';
 
+    // autocomplete candidates can be narrowed only when appending
     if (impl->cursorPos > 0)
+        impl->autocompleteLen = 0;
+
+    ++impl->cmdSize;
+
+    if (impl->cursorPos > 0) {
+        // rest of the line is moved to the right
+        ++impl->inputLineLength;
+        impl->liveAutocompletion = NULL;
         writeToOutput(cli, escSeqInsertChar); // Insert Character
+    } else if (impl->inputLineLength < impl->cmdSize) {
+        // otherwise char replaces a char of live autocompletion
+        impl->inputLineLength = impl->cmdSize;
+    }
 
     cli->writeChar(cli, c);
 }
 
+static bool onPastedLine(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+
+    // escape sequences and editing in the middle of the command
+    // are left to regular processing
+    if (IS_FLAG_SET(impl->flags, CLI_FLAG_ESCAPE_MODE) || impl->lastChar == 0x1B ||
+        impl->cursorPos > 0)
+        return false;
+
+    FifoBuf *rx = &impl->rxBuffer;
+    uint16_t lineLen = 0;
+    uint16_t pos = rx->front;
+    while (pos != rx->back && isDisplayableChar(rx->buf[pos])) {
+        ++lineLen;
+        pos = (uint16_t) (pos + 1) % rx->size;
+    }
+
+    if (lineLen == 0 || pos == rx->back || (rx->buf[pos] != '\r' && rx->buf[pos] != '\n'))
+        return false;
+
+    uint16_t oldSize = impl->cmdSize;
+    for (uint16_t i = 0; i < lineLen; ++i) {
+        char c = fifoBufPop(rx);
+        // same limit as in onCharInput, extra chars are dropped
+        if (impl->cmdSize + 2 < impl->cmdMaxSize) {
+            impl->cmdBuffer[impl->cmdSize] = c;
+            ++impl->cmdSize;
+        }
+        impl->lastChar = c;
+    }
+    impl->cmdBuffer[impl->cmdSize] = '\0';
+    if (impl->inputLineLength < impl->cmdSize)
+        impl->inputLineLength = impl->cmdSize;
+
+    writeToOutput(cli, &impl->cmdBuffer[oldSize]);
+
+    return true;
+}
+
 static void onControlInput(EmbeddedCli *cli, char c) {
     PREPARE_IMPL(cli);
 
@@ -1141,6 +1961,7 @@ static void onControlInput(EmbeddedCli *cli, char c) {
     if (c == '\r' || c == '\n') {
         // try to autocomplete command and then process it
         onAutocompleteRequest(cli);
+        joinCommand(cli);
 
         writeToOutput(cli, lineBreak);
 
@@ -1151,16 +1972,29 @@ static void onControlInput(EmbeddedCli *cli, char c) {
         impl->inputLineLength = 0;
         impl->history.current = 0;
         impl->cursorPos = 0;
+        impl->autocompleteLen = 0;
 
-        writeToOutput(cli, impl->invitation);
+        // otherwise invitation is printed once output is produced
+        if (impl->outputProducer == NULL)
+            writeToOutput(cli, impl->invitation);
     } else if ((c == '\b' || c == 0x7F) && ((impl->cmdSize - impl->cursorPos) > 0)) {
         // remove char from screen
-        writeToOutput(cli, escSeqCursorLeft); // Move cursor to left
-        writeToOutput(cli, escSeqDeleteChar); // And remove character
+        if (IS_FLAG_SET(impl->flags, CLI_FLAG_SHORT_CURSOR_MOVES) &&
+            impl->cursorPos == 0 && impl->inputLineLength == impl->cmdSize) {
+            // nothing after it on the line, so overwrite it with a space
+            writeToOutput(cli, eraseLastChar);
+        } else {
+            moveCursor(cli, 1, CURSOR_DIRECTION_BACKWARD); // Move cursor to left
+            writeToOutput(cli, escSeqDeleteChar); // And remove character
+        }
         // and from buffer
-        size_t insertPos = strlen(impl->cmdBuffer) - impl->cursorPos;
-        memmove(&impl->cmdBuffer[insertPos - 1], &impl->cmdBuffer[insertPos], impl->cursorPos + 1);
+        size_t insertPos = impl->cmdSize - impl->cursorPos;
+        impl->cmdBuffer[insertPos - 1] = '\0';
         --impl->cmdSize;
+        impl->autocompleteLen = 0;
+        // rest of the line is moved to the left
+        --impl->inputLineLength;
+        impl->liveAutocompletion = NULL;
     } else if (c == '\t') {
         onAutocompleteRequest(cli);
     }
@@ -1215,24 +2049,38 @@ static void parseCommand(EmbeddedCli *cli) {
         return;
 
     // try to find command in bindings
-    for (int i = 0; i < impl->bindingsCount; ++i) {
-        if (strcmp(cmdName, impl->bindings[i].name) == 0) {
-            if (impl->bindings[i].binding == NULL)
-                break;
+    const CliCommandBinding *binding = findBinding(cli, cmdName);
 
-            if (impl->bindings[i].tokenizeArgs)
-                embeddedCliTokenizeArgs(cmdArgs);
-            // currently, output is blank line, so we can just print directly
-            SET_FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
-            // check if help was requested (help is printed when no other options are set)
-            if (cmdArgs != NULL && (strcmp(cmdArgs, "-h") == 0 || strcmp(cmdArgs, "--help") == 0)) {
-                printBindingHelp(cli, &impl->bindings[i]);
-            } else {
-                impl->bindings[i].binding(cli, cmdArgs, impl->bindings[i].context);
-            }
-            UNSET_U8FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
-            return;
+    // walk down groups while args start with name of a subcommand
+    const CliCommandBinding *subcommand;
+    while (binding != NULL && binding->subcommands != NULL && cmdArgs != NULL &&
+           (subcommand = findSubcommand(binding->subcommands, &cmdArgs)) != NULL) {
+        binding = subcommand;
+    }
+
+    if (binding != NULL && (binding->binding != NULL || binding->subcommands != NULL)) {
+        if (binding->tokenizeArgs)
+            embeddedCliTokenizeArgs(cmdArgs);
+        // currently, output is blank line, so we can just print directly
+        SET_FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
+        // check if help was requested (help is printed when no other options are set)
+        if (cmdArgs != NULL && (strcmp(cmdArgs, "-h") == 0 || strcmp(cmdArgs, "--help") == 0)) {
+            printBindingHelp(cli, binding);
+            if (binding->subcommands != NULL)
+                printSubcommands(cli, binding->subcommands);
+        } else if (binding->binding != NULL) {
+            binding->binding(cli, cmdArgs, binding->context);
+        } else if (cmdArgs != NULL) {
+            // group without binding function accepts only its subcommands
+            onUnknownSubcommand(cli, binding->subcommands, cmdArgs);
+        } else {
+            printBindingHelp(cli, binding);
+            printSubcommands(cli, binding->subcommands);
         }
+        // command with pending output is still running
+        if (impl->outputProducer == NULL)
+            UNSET_U8FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
+        return;
     }
 
     // command not found in bindings or binding was null
@@ -1245,13 +2093,14 @@ static void parseCommand(EmbeddedCli *cli) {
         // currently, output is blank line, so we can just print directly
         SET_FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
         cli->onCommand(cli, &command);
-        UNSET_U8FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
+        if (impl->outputProducer == NULL)
+            UNSET_U8FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
     } else {
         onUnknownCommand(cli, cmdName);
     }
 }
 
-static void printBindingHelp(EmbeddedCli *cli, CliCommandBinding *binding) {
+static void printBindingHelp(EmbeddedCli *cli, const CliCommandBinding *binding) {
     if (binding->help != NULL) {
         cli->writeChar(cli, '\t');
         writeToOutput(cli, binding->help);
@@ -1259,13 +2108,24 @@ static void printBindingHelp(EmbeddedCli *cli, CliCommandBinding *binding) {
     }
 }
 
+static void printSubcommands(EmbeddedCli *cli, const CliBindingTable *group) {
+    BindingCursor cursor = {"", -1, 0};
+    const CliCommandBinding *binding;
+    while ((binding = nextGroupBinding(group, &cursor)) != NULL) {
+        writeToOutput(cli, "\t * ");
+        writeToOutput(cli, binding->name);
+        writeToOutput(cli, lineBreak);
+    }
+}
+
 static void initInternalBindings(EmbeddedCli *cli) {
     CliCommandBinding b = {
             "help",
             "Print list of commands",
             true,
             NULL,
-            onHelp
+            onHelp,
+            NULL
     };
     embeddedCliAddBinding(cli, b);
 }
@@ -1282,98 +2142,470 @@ static void onHelp(EmbeddedCli *cli, char *tokens, void *context) {
 
     uint16_t tokenCount = embeddedCliGetTokenCount(tokens);
     if (tokenCount == 0) {
-        for (int i = 0; i < impl->bindingsCount; ++i) {
-            writeToOutput(cli, " * ");
-            writeToOutput(cli, impl->bindings[i].name);
-            writeToOutput(cli, lineBreak);
-            printBindingHelp(cli, &impl->bindings[i]);
-        }
-    } else if (tokenCount == 1) {
-        // try find command
-        const char *helpStr = NULL;
+        // listing of all bindings can be long, so it is produced lazily
+        impl->helpCursor.name = "";
+        impl->helpCursor.source = -1;
+        impl->helpCursor.index = 0;
+        embeddedCliSetOutputProducer(cli, produceHelpListing, NULL);
+    } else {
+        // try find command, and then each subcommand in its group
         const char *cmdName = embeddedCliGetToken(tokens, 1);
-        bool found = false;
-        for (int i = 0; i < impl->bindingsCount; ++i) {
-            if (strcmp(impl->bindings[i].name, cmdName) == 0) {
-                helpStr = impl->bindings[i].help;
-                found = true;
-                break;
-            }
+        const CliCommandBinding *group = NULL;
+        const CliCommandBinding *binding = findBinding(cli, cmdName);
+        for (uint16_t i = 2; binding != NULL && i <= tokenCount; ++i) {
+            group = binding;
+            cmdName = embeddedCliGetToken(tokens, i);
+            binding = group->subcommands != NULL ? findTableBinding(group->subcommands, cmdName) : NULL;
         }
-        if (found && helpStr != NULL) {
+
+        if (binding == NULL && group != NULL && group->subcommands != NULL) {
+            onUnknownSubcommand(cli, group->subcommands, cmdName);
+        } else if (binding == NULL && group != NULL) {
+            writeToOutput(cli, "Command \"");
+            writeToOutput(cli, group->name);
+            writeToOutput(cli, "\" has no subcommands");
+            writeToOutput(cli, lineBreak);
+        } else if (binding == NULL) {
+            onUnknownCommand(cli, cmdName);
+        } else if (binding->help != NULL || binding->subcommands != NULL) {
             writeToOutput(cli, " * ");
             writeToOutput(cli, cmdName);
             writeToOutput(cli, lineBreak);
-            cli->writeChar(cli, '\t');
-            writeToOutput(cli, helpStr);
-            writeToOutput(cli, lineBreak);
-        } else if (found) {
+            printBindingHelp(cli, binding);
+            if (binding->subcommands != NULL)
+                printSubcommands(cli, binding->subcommands);
+        } else {
             writeToOutput(cli, "Help is not available");
             writeToOutput(cli, lineBreak);
-        } else {
-            onUnknownCommand(cli, cmdName);
         }
-    } else {
-        writeToOutput(cli, "Command \"help\" receives one or zero arguments");
-        writeToOutput(cli, lineBreak);
     }
 }
 
-static void onUnknownCommand(EmbeddedCli *cli, const char *name) {
-    writeToOutput(cli, "Unknown command: \"");
-    writeToOutput(cli, name);
-    writeToOutput(cli, "\". Write \"help\" for a list of available commands");
+static bool produceHelpListing(EmbeddedCli *cli, void *context) {
+    UNUSED(context);
+    PREPARE_IMPL(cli);
+
+    const CliCommandBinding *binding = nextBinding(cli, &impl->helpCursor);
+    if (binding == NULL)
+        return false;
+
+    writeToOutput(cli, " * ");
+    writeToOutput(cli, binding->name);
     writeToOutput(cli, lineBreak);
+    printBindingHelp(cli, binding);
+
+    // finish right after last binding, instead of on the next call
+    BindingCursor next = impl->helpCursor;
+    return nextBinding(cli, &next) != NULL;
 }
 
-static AutocompletedCommand getAutocompletedCommand(EmbeddedCli *cli, const char *prefix) {
-    AutocompletedCommand cmd = {NULL, 0, 0};
+static void finishPendingOutput(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+
+    impl->outputProducer = NULL;
+    impl->outputProducerContext = NULL;
+    impl->helpCursor.source = -1;
+    UNSET_U8FLAG(impl->flags, CLI_FLAG_DIRECT_PRINT);
 
-    size_t prefixLen = strlen(prefix);
+    // no input is processed while output is pending, so command is empty
+    writeToOutput(cli, impl->invitation);
+}
 
+static const CliCommandBinding *findBinding(EmbeddedCli *cli, const char *name) {
     PREPARE_IMPL(cli);
-    if (impl->bindingsCount == 0 || prefixLen == 0)
-        return cmd;
 
+    for (int source = 0; source <= impl->bindingTablesCount; ++source) {
+        if (source > 0 && impl->bindingTables[source - 1].table.hash != NULL) {
+            const CliCommandBinding *binding = findHashedBinding(&impl->bindingTables[source - 1].table, name);
+            if (binding != NULL)
+                return binding;
+            continue;
+        }
+
+        uint16_t count;
+        const CliCommandBinding *bindings = getBindingSource(cli, source, &count);
+        if (!isBindingSourceSorted(cli, source)) {
+            for (uint16_t i = 0; i < count; ++i) {
+                if (strcmp(bindings[i].name, name) == 0)
+                    return &bindings[i];
+            }
+            continue;
+        }
+
+        uint16_t first = findBindingBound(bindings, count, name, false);
+        if (first < count && strcmp(bindings[first].name, name) == 0)
+            return &bindings[first];
+    }
+    return NULL;
+}
+
+static const CliCommandBinding *findHashedBinding(const CliBindingTable *table, const char *name) {
+    const CliBindingHash *hash = table->hash;
 
-    for (int i = 0; i < impl->bindingsCount; ++i) {
-        const char *name = impl->bindings[i].name;
-        size_t len = strlen(name);
+    uint32_t h = hash->seed;
+    for (const char *c = name; *c != '\0'; ++c) {
+        h = (h ^ (uint8_t) *c) * 16777619u;
+    }
+    uint32_t g = h * 0x9E3779B1u;
+    uint32_t d = hash->displacements[h % hash->bucketCount];
+    uint32_t slot = ((g >> 16) + d * ((g & 0xFFFFu) | 1u)) & (uint32_t) (hash->slotCount - 1);
+
+    uint16_t index = hash->slots[slot];
+    if (index < table->count && strcmp(table->bindings[index].name, name) == 0)
+        return &table->bindings[index];
+    return NULL;
+}
+
+static const CliCommandBinding *findTableBinding(const CliBindingTable *table, const char *name) {
+    if (table->hash != NULL)
+        return findHashedBinding(table, name);
+
+    for (uint16_t i = 0; i < table->count; ++i) {
+        if (strcmp(table->bindings[i].name, name) == 0)
+            return &table->bindings[i];
+    }
+    return NULL;
+}
+
+static const CliCommandBinding *findSubcommand(const CliBindingTable *group, char **args) {
+    char *name = *args;
+    char *nameEnd = name;
+    while (*nameEnd != '\0' && *nameEnd != ' ')
+        ++nameEnd;
+
+    // name is terminated in place, as command name is
+    char separator = *nameEnd;
+    *nameEnd = '\0';
+    const CliCommandBinding *binding = findTableBinding(group, name);
+    if (binding == NULL) {
+        *nameEnd = separator;
+        return NULL;
+    }
+
+    char *rest = nameEnd;
+    if (separator == ' ') {
+        ++rest;
+        while (*rest == ' ')
+            *rest++ = '\0';
+    }
+    *args = *rest != '\0' ? rest : NULL;
+    return binding;
+}
+
+static uint16_t findBindingBound(const CliCommandBinding *bindings, uint16_t count,
+                                 const char *name, bool upper) {
+    uint16_t first = 0;
+    uint16_t end = count;
+    while (first < end) {
+        uint16_t mid = (uint16_t) (first + (end - first) / 2);
+        int cmp = strcmp(bindings[mid].name, name);
+        if (cmp < 0 || (upper && cmp == 0))
+            first = (uint16_t) (mid + 1);
+        else
+            end = mid;
+    }
+    return first;
+}
+
+static const CliCommandBinding *getBindingSource(EmbeddedCli *cli, int source, uint16_t *count) {
+    PREPARE_IMPL(cli);
+
+    if (source == 0) {
+        *count = impl->bindingsCount;
+        return impl->bindings;
+    }
+    if (source > 0 && source <= impl->bindingTablesCount) {
+        *count = impl->bindingTables[source - 1].table.count;
+        return impl->bindingTables[source - 1].table.bindings;
+    }
+    *count = 0;
+    return NULL;
+}
 
-        // unset autocomplete flag
-        UNSET_U8FLAG(impl->bindingsFlags[i], BINDING_FLAG_AUTOCOMPLETE);
+static bool isBindingSourceSorted(EmbeddedCli *cli, int source) {
+    PREPARE_IMPL(cli);
+    return source <= 0 || source > impl->bindingTablesCount || impl->bindingTables[source - 1].sorted;
+}
 
-        if (len < prefixLen)
+static uint16_t findNextUnsortedBinding(const CliCommandBinding *bindings, uint16_t count,
+                                        const BindingCursor *cursor, int source) {
+    uint16_t next = count;
+    for (uint16_t i = 0; i < count; ++i) {
+        // skip bindings up to and including the cursor
+        int cmp = strcmp(bindings[i].name, cursor->name);
+        if (cmp < 0 || (cmp == 0 && (source < cursor->source ||
+                                     (source == cursor->source && i <= cursor->index))))
             continue;
+        if (next == count || strcmp(bindings[i].name, bindings[next].name) < 0)
+            next = i;
+    }
+    return next;
+}
 
-        // check if this command is candidate for autocomplete
-        bool isCandidate = true;
-        for (size_t j = 0; j < prefixLen; ++j) {
-            if (prefix[j] != name[j]) {
-                isCandidate = false;
-                break;
+static const CliCommandBinding *nextBinding(EmbeddedCli *cli, BindingCursor *cursor) {
+    PREPARE_IMPL(cli);
+
+    const CliCommandBinding *next = NULL;
+    int nextSource = -1;
+    uint16_t nextIndex = 0;
+
+    // next binding of each source is the first one after the cursor,
+    // the smallest of them is next binding overall
+    for (int source = 0; source <= impl->bindingTablesCount; ++source) {
+        uint16_t count;
+        const CliCommandBinding *bindings = getBindingSource(cli, source, &count);
+        uint16_t index;
+        if (!isBindingSourceSorted(cli, source))
+            index = findNextUnsortedBinding(bindings, count, cursor, source);
+        else if (source == cursor->source)
+            index = (uint16_t) (cursor->index + 1);
+        else
+            index = findBindingBound(bindings, count, cursor->name, source < cursor->source);
+
+        if (index < count && (next == NULL || strcmp(bindings[index].name, next->name) < 0)) {
+            next = &bindings[index];
+            nextSource = source;
+            nextIndex = index;
+        }
+    }
+
+    if (next != NULL) {
+        cursor->name = next->name;
+        cursor->source = nextSource;
+        cursor->index = nextIndex;
+    }
+    return next;
+}
+
+static const CliCommandBinding *nextGroupBinding(const CliBindingTable *group, BindingCursor *cursor) {
+    // subcommands are not required to be sorted
+    uint16_t index = findNextUnsortedBinding(group->bindings, group->count, cursor, 0);
+    if (index == group->count)
+        return NULL;
+
+    cursor->name = group->bindings[index].name;
+    cursor->source = 0;
+    cursor->index = index;
+    return &group->bindings[index];
+}
+
+static void findCandidates(EmbeddedCli *cli, const CliCommandBinding *bindings,
+                           uint16_t *first, uint16_t *end, size_t from, size_t prefixLen) {
+    // binary search for first candidate
+    uint16_t lo = *first;
+    uint16_t hi = *end;
+    while (lo < hi) {
+        uint16_t mid = (uint16_t) (lo + (hi - lo) / 2);
+        if (compareToCommand(cli, bindings[mid].name, from, prefixLen) < 0)
+            lo = (uint16_t) (mid + 1);
+        else
+            hi = mid;
+    }
+    *first = lo;
+
+    // and for the end of candidates
+    hi = *end;
+    while (lo < hi) {
+        uint16_t mid = (uint16_t) (lo + (hi - lo) / 2);
+        if (compareToCommand(cli, bindings[mid].name, from, prefixLen) <= 0)
+            lo = (uint16_t) (mid + 1);
+        else
+            hi = mid;
+    }
+    *end = lo;
+}
+
+static int compareToCommand(EmbeddedCli *cli, const char *name, size_t from, size_t len) {
+    PREPARE_IMPL(cli);
+    // current command is stored in two parts
+    const char *tail = getCommandTail(cli);
+    size_t headLen = impl->cmdSize - impl->cursorPos;
+
+    for (size_t i = from; i < len; ++i) {
+        char c = i < headLen ? impl->cmdBuffer[i] : tail[i - headLen];
+        // comparison stops at the end of shorter names,
+        // since command never contains '\0'
+        if (name[i] != c)
+            return (unsigned char) name[i] - (unsigned char) c;
+    }
+    return 0;
+}
+
+static int compareToCommandWord(EmbeddedCli *cli, const char *name, uint16_t wordStart, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        char c = getCommandChar(cli, (uint16_t) (wordStart + i));
+        if (name[i] != c)
+            return (unsigned char) name[i] - (unsigned char) c;
+    }
+    return 0;
+}
+
+static char getCommandChar(EmbeddedCli *cli, uint16_t i) {
+    PREPARE_IMPL(cli);
+    uint16_t headLen = (uint16_t) (impl->cmdSize - impl->cursorPos);
+    return i < headLen ? impl->cmdBuffer[i] : getCommandTail(cli)[i - headLen];
+}
+
+static const CliCommandBinding *findCommandWord(EmbeddedCli *cli, const CliBindingTable *group,
+                                                uint16_t wordStart, uint16_t wordLen) {
+    PREPARE_IMPL(cli);
+
+    if (group != NULL) {
+        for (uint16_t i = 0; i < group->count; ++i) {
+            const char *name = group->bindings[i].name;
+            if (compareToCommandWord(cli, name, wordStart, wordLen) == 0 && name[wordLen] == '\0')
+                return &group->bindings[i];
+        }
+        return NULL;
+    }
+
+    for (int source = 0; source <= impl->bindingTablesCount; ++source) {
+        uint16_t first = 0;
+        uint16_t end;
+        const CliCommandBinding *bindings = getBindingSource(cli, source, &end);
+        if (!isBindingSourceSorted(cli, source)) {
+            for (uint16_t i = 0; i < end; ++i) {
+                if (compareToCommand(cli, bindings[i].name, 0, wordLen) == 0 && bindings[i].name[wordLen] == '\0')
+                    return &bindings[i];
             }
+            continue;
         }
-        if (!isCandidate)
+
+        // exact match is the first of bindings starting with the word
+        findCandidates(cli, bindings, &first, &end, 0, wordLen);
+        if (first < end && bindings[first].name[wordLen] == '\0')
+            return &bindings[first];
+    }
+    return NULL;
+}
+
+static uint16_t findSubcommandGroup(EmbeddedCli *cli, const CliBindingTable **group) {
+    PREPARE_IMPL(cli);
+
+    *group = NULL;
+    uint16_t wordStart = 0;
+    for (uint16_t i = 0; i < impl->cmdSize; ++i) {
+        if (getCommandChar(cli, i) != ' ')
             continue;
 
-        impl->bindingsFlags[i] |= BINDING_FLAG_AUTOCOMPLETE;
+        // word before the space must name a group, which contains next word
+        const CliCommandBinding *binding = NULL;
+        if (i > wordStart && (wordStart == 0 || *group != NULL))
+            binding = findCommandWord(cli, *group, wordStart, (uint16_t) (i - wordStart));
+        *group = binding != NULL ? binding->subcommands : NULL;
+        wordStart = (uint16_t) (i + 1);
+    }
+    return wordStart;
+}
 
-        if (cmd.candidateCount == 0 || len < cmd.autocompletedLen)
-            cmd.autocompletedLen = (uint16_t) len;
+static void addUnsortedCandidates(EmbeddedCli *cli, AutocompletedCommand *cmd,
+                                  const CliCommandBinding *bindings, uint16_t count) {
+    PREPARE_IMPL(cli);
+    size_t prefixLen = impl->cmdSize - cmd->wordStart;
 
-        ++cmd.candidateCount;
+    for (uint16_t i = 0; i < count; ++i) {
+        if (compareToCommandWord(cli, bindings[i].name, cmd->wordStart, prefixLen) != 0)
+            continue;
+        if (cmd->firstCandidate == NULL) {
+            cmd->firstCandidate = bindings[i].name;
+            cmd->autocompletedLen = (uint16_t) strlen(cmd->firstCandidate);
+        }
+        ++cmd->candidateCount;
 
-        if (cmd.candidateCount == 1) {
-            cmd.firstCandidate = name;
+        size_t len = prefixLen;
+        while (len < cmd->autocompletedLen && cmd->firstCandidate[len] == bindings[i].name[len])
+            ++len;
+        cmd->autocompletedLen = (uint16_t) len;
+    }
+}
+
+static void onUnknownCommand(EmbeddedCli *cli, const char *name) {
+    writeToOutput(cli, "Unknown command: \"");
+    writeToOutput(cli, name);
+    writeToOutput(cli, "\". Write \"help\" for a list of available commands");
+    writeToOutput(cli, lineBreak);
+}
+
+static void onUnknownSubcommand(EmbeddedCli *cli, const CliBindingTable *group, const char *name) {
+    writeToOutput(cli, "Unknown subcommand: \"");
+    writeToOutput(cli, name);
+    writeToOutput(cli, "\". Available subcommands:");
+    writeToOutput(cli, lineBreak);
+    printSubcommands(cli, group);
+}
+
+static AutocompletedCommand getAutocompletedCommand(EmbeddedCli *cli) {
+    AutocompletedCommand cmd = {NULL, 0, 0, 0, NULL};
+
+    PREPARE_IMPL(cli);
+    size_t prefixLen = impl->cmdSize;
+
+    if (prefixLen == 0) {
+        impl->autocompleteLen = 0;
+        return cmd;
+    }
+
+    // words after command name are completed from subcommands of the group
+    // named by previous words
+    cmd.wordStart = findSubcommandGroup(cli, &cmd.group);
+    if (cmd.wordStart > 0) {
+        // range of candidates among command names doesn't apply anymore
+        impl->autocompleteLen = 0;
+        // like an empty command, an empty word has no candidates
+        if (cmd.group != NULL && cmd.wordStart < prefixLen)
+            addUnsortedCandidates(cli, &cmd, cmd.group->bindings, cmd.group->count);
+        return cmd;
+    }
+
+    // candidates are searched for in list of bindings and in each binding
+    // table. Since bindings are sorted, common prefix of candidates from one
+    // source is common prefix of the first and the last of them
+    for (int source = 0; source <= impl->bindingTablesCount; ++source) {
+        uint16_t first = 0;
+        uint16_t end;
+        const CliCommandBinding *bindings = getBindingSource(cli, source, &end);
+        size_t checkFrom = 0;
+
+        // each binding of a table which is not sorted is compared
+        if (!isBindingSourceSorted(cli, source)) {
+            addUnsortedCandidates(cli, &cmd, bindings, end);
             continue;
         }
 
-        for (size_t j = impl->cmdSize; j < cmd.autocompletedLen; ++j) {
-            if (cmd.firstCandidate[j] != name[j]) {
-                cmd.autocompletedLen = (uint16_t) j;
-                break;
-            }
+        // if chars were only appended since last call, candidates are within
+        // previous range and only appended chars need to be compared
+        if (source == 0 && impl->autocompleteLen > 0 && impl->autocompleteLen <= prefixLen) {
+            first = impl->autocompleteFirst;
+            end = impl->autocompleteEnd;
+            checkFrom = impl->autocompleteLen;
+        }
+
+        findCandidates(cli, bindings, &first, &end, checkFrom, prefixLen);
+
+        if (source == 0) {
+            impl->autocompleteLen = (uint16_t) prefixLen;
+            impl->autocompleteFirst = first;
+            impl->autocompleteEnd = end;
+        }
+
+        if (first == end)
+            continue;
+
+        if (cmd.firstCandidate == NULL) {
+            cmd.firstCandidate = bindings[first].name;
+            if (source == 0)
+                cmd.autocompletedLen = impl->bindingsNameLen[first];
+            else
+                cmd.autocompletedLen = (uint16_t) strlen(cmd.firstCandidate);
+        }
+        cmd.candidateCount = (uint16_t) (cmd.candidateCount + (end - first));
+
+        const char *bounds[2] = {bindings[first].name, bindings[end - 1].name};
+        for (int i = 0; i < 2; ++i) {
+            size_t len = prefixLen;
+            while (len < cmd.autocompletedLen && cmd.firstCandidate[len] == bounds[i][len])
+                ++len;
+            cmd.autocompletedLen = (uint16_t) len;
         }
     }
 
@@ -1386,51 +2618,82 @@ static void printLiveAutocompletion(EmbeddedCli *cli) {
     if (!IS_FLAG_SET(impl->flags, CLI_FLAG_AUTOCOMPLETE_ENABLED))
         return;
 
-    AutocompletedCommand cmd = getAutocompletedCommand(cli, impl->cmdBuffer);
+    AutocompletedCommand cmd = getAutocompletedCommand(cli);
 
+    // end of autocompleted line, candidate is shown from wordStart
+    uint16_t lineEnd = (uint16_t) (cmd.wordStart + cmd.autocompletedLen);
     if (cmd.candidateCount == 0) {
-        cmd.autocompletedLen = impl->cmdSize;
+        lineEnd = impl->cmdSize;
+    }
+
+    // skip the part of live autocompletion which is already on screen
+    uint16_t from = impl->cmdSize;
+    if (impl->liveAutocompletion != NULL && impl->liveAutocompletionStart == cmd.wordStart) {
+        while (from < lineEnd && from < impl->inputLineLength &&
+               cmd.firstCandidate[from - cmd.wordStart] ==
+               impl->liveAutocompletion[from - cmd.wordStart])
+            ++from;
     }
 
+    if (from == lineEnd && from == impl->inputLineLength)
+        return;
+
     // save cursor location
     writeToOutput(cli, escSeqCursorSave);
 
-    moveCursor(cli, impl->cursorPos, CURSOR_DIRECTION_FORWARD);
+    moveCursor(cli, (uint16_t) (impl->cursorPos + from - impl->cmdSize), CURSOR_DIRECTION_FORWARD);
 
     // print live autocompletion (or nothing, if it doesn't exist)
-    for (size_t i = impl->cmdSize; i < cmd.autocompletedLen; ++i) {
-        cli->writeChar(cli, cmd.firstCandidate[i]);
+    for (size_t i = from; i < lineEnd; ++i) {
+        cli->writeChar(cli, cmd.firstCandidate[i - cmd.wordStart]);
     }
-    // replace with spaces previous autocompletion
-    for (size_t i = cmd.autocompletedLen; i < impl->inputLineLength; ++i) {
-        cli->writeChar(cli, ' ');
-    }
-    impl->inputLineLength = cmd.autocompletedLen;
+    // remove the rest of previous autocompletion
+    if (impl->inputLineLength > lineEnd)
+        writeToOutput(cli, escSeqEraseLine);
+    impl->inputLineLength = lineEnd;
+    impl->liveAutocompletion = cmd.firstCandidate;
+    impl->liveAutocompletionStart = cmd.wordStart;
 
     // restore cursor
     writeToOutput(cli, escSeqCursorRestore);
 }
 
+static void flushLiveAutocompletion(EmbeddedCli *cli, bool *pending) {
+    if (*pending) {
+        printLiveAutocompletion(cli);
+        *pending = false;
+    }
+}
+
 static void onAutocompleteRequest(EmbeddedCli *cli) {
     PREPARE_IMPL(cli);
 
-    AutocompletedCommand cmd = getAutocompletedCommand(cli, impl->cmdBuffer);
+    AutocompletedCommand cmd = getAutocompletedCommand(cli);
 
     if (cmd.candidateCount == 0)
         return;
 
-    if (cmd.candidateCount == 1 || cmd.autocompletedLen > impl->cmdSize) {
-        // can copy from index cmdSize, but prefix is the same, so copy everything
-        memcpy(impl->cmdBuffer, cmd.firstCandidate, cmd.autocompletedLen);
+    // command is rewritten below, keep cursor position on screen
+    uint16_t cursorCol = (uint16_t) (impl->cmdSize - impl->cursorPos);
+    joinCommand(cli);
+
+    uint16_t completedLen = (uint16_t) (cmd.wordStart + cmd.autocompletedLen);
+    if (cmd.candidateCount == 1 || completedLen > impl->cmdSize) {
+        // same limit as in onCharInput, including the space after the name
+        if (completedLen + 3 >= impl->cmdMaxSize)
+            return;
+
+        // can copy from index cmdSize, but prefix is the same, so copy whole word
+        memcpy(&impl->cmdBuffer[cmd.wordStart], cmd.firstCandidate, cmd.autocompletedLen);
         if (cmd.candidateCount == 1) {
-            impl->cmdBuffer[cmd.autocompletedLen] = ' ';
-            ++cmd.autocompletedLen;
+            impl->cmdBuffer[completedLen] = ' ';
+            ++completedLen;
         }
-        impl->cmdBuffer[cmd.autocompletedLen] = '\0';
+        impl->cmdBuffer[completedLen] = '\0';
 
-        writeToOutput(cli, &impl->cmdBuffer[impl->cmdSize - impl->cursorPos]);
-        impl->cmdSize = cmd.autocompletedLen;
-        impl->inputLineLength = impl->cmdSize;
+        // completed chars are usually on screen already as live autocompletion
+        updateInputLine(cli, cursorCol, impl->cmdSize, impl->cmdBuffer, completedLen);
+        impl->cmdSize = completedLen;
         impl->cursorPos = 0; // Cursor has been moved to the end
         return;
     }
@@ -1440,15 +2703,15 @@ static void onAutocompleteRequest(EmbeddedCli *cli) {
     // we need to completely clear current line since it begins with invitation
     clearCurrentLine(cli);
 
-    for (int i = 0; i < impl->bindingsCount; ++i) {
-        // autocomplete flag is set for all candidates by last call to
-        // getAutocompletedCommand
-        if (!(impl->bindingsFlags[i] & BINDING_FLAG_AUTOCOMPLETE))
-            continue;
-
-        const char *name = impl->bindings[i].name;
-
-        writeToOutput(cli, name);
+    // candidates from all sources (or from the group) are listed in order
+    // of their names
+    const char *word = &impl->cmdBuffer[cmd.wordStart];
+    size_t wordLen = impl->cmdSize - cmd.wordStart;
+    BindingCursor cursor = {word, -1, 0};
+    const CliCommandBinding *binding;
+    while ((binding = cmd.group != NULL ? nextGroupBinding(cmd.group, &cursor) : nextBinding(cli, &cursor)) != NULL &&
+           strncmp(binding->name, word, wordLen) == 0) {
+        writeToOutput(cli, binding->name);
         writeToOutput(cli, lineBreak);
     }
 
@@ -1460,18 +2723,65 @@ static void onAutocompleteRequest(EmbeddedCli *cli) {
 
 static void clearCurrentLine(EmbeddedCli *cli) {
     PREPARE_IMPL(cli);
-    size_t len = impl->inputLineLength + strlen(impl->invitation);
 
     cli->writeChar(cli, '\r');
-    for (size_t i = 0; i < len; ++i) {
-        cli->writeChar(cli, ' ');
-    }
-    cli->writeChar(cli, '\r');
+    writeToOutput(cli, escSeqEraseLine);
     impl->inputLineLength = 0;
 
     impl->cursorPos = 0;
 }
 
+static void updateInputLine(EmbeddedCli *cli, uint16_t cursorCol, uint16_t shownCmdLen,
+                            const char *text, uint16_t len) {
+    PREPARE_IMPL(cli);
+
+    // find how much of the text is on screen already
+    uint16_t same = 0;
+    while (same < len && same < impl->inputLineLength) {
+        char shown;
+        if (same < shownCmdLen)
+            shown = impl->cmdBuffer[same];
+        else if (impl->liveAutocompletion != NULL && same >= impl->liveAutocompletionStart)
+            shown = impl->liveAutocompletion[same - impl->liveAutocompletionStart];
+        else
+            break;
+        if (shown != text[same])
+            break;
+        ++same;
+    }
+
+    if (same < cursorCol) {
+        moveCursor(cli, (uint16_t) (cursorCol - same), CURSOR_DIRECTION_BACKWARD);
+    } else if (same - cursorCol > 4) {
+        // escape sequence is shorter than chars it skips
+        moveCursor(cli, (uint16_t) (same - cursorCol), CURSOR_DIRECTION_FORWARD);
+    } else {
+        same = cursorCol;
+    }
+
+    for (uint16_t i = same; i < len; ++i) {
+        cli->writeChar(cli, text[i]);
+    }
+    if (impl->inputLineLength > len)
+        writeToOutput(cli, escSeqEraseLine);
+    impl->inputLineLength = len;
+}
+
+static char *getCommandTail(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    return &impl->cmdBuffer[impl->cmdMaxSize - 1 - impl->cursorPos];
+}
+
+static void joinCommand(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    if (impl->cursorPos == 0)
+        return;
+
+    // tail is moved together with its terminating null
+    memmove(&impl->cmdBuffer[impl->cmdSize - impl->cursorPos], getCommandTail(cli), impl->cursorPos + 1);
+    impl->cursorPos = 0;
+}
+
 static void writeToOutput(EmbeddedCli *cli, const char *str) {
     size_t len = strlen(str);
 
@@ -1485,11 +2795,37 @@ static void moveCursor(EmbeddedCli* cli, uint16_t count, bool direction) {
     if (count == 0)
         return;
 
-    // 5 = uint16_t max, 3 = escape sequence, 1 = string termination
-    char escBuffer[5 + 3 + 1] = { 0 };
-    char dirChar = direction ? escSeqCursorRight[2] : escSeqCursorLeft[2];
-    sprintf(escBuffer, "\x1B[%u%c", count, dirChar);
-    writeToOutput(cli, escBuffer);
+    PREPARE_IMPL(cli);
+    // backspaces are shorter than escape sequence for a few chars
+    if (IS_FLAG_SET(impl->flags, CLI_FLAG_SHORT_CURSOR_MOVES) && !direction && count <= 3) {
+        for (uint16_t i = 0; i < count; ++i)
+            cli->writeChar(cli, '\b');
+        return;
+    }
+
+    // count of 1 is the default and can be omitted
+    if (count == 1) {
+        writeToOutput(cli, direction ? escSeqCursorRight : escSeqCursorLeft);
+        return;
+    }
+
+    writeToOutput(cli, escSeqIntroducer);
+    writeDecimal(cli, count);
+    cli->writeChar(cli, direction ? escSeqCursorRight[2] : escSeqCursorLeft[2]);
+}
+
+static void writeDecimal(EmbeddedCli *cli, uint16_t value) {
+    // 5 = uint16_t max, digits are produced starting from the last one
+    char digits[5];
+    uint8_t len = 0;
+    do {
+        digits[len++] = (char) ('0' + value % 10);
+        value = (uint16_t) (value / 10);
+    } while (value > 0);
+
+    while (len > 0) {
+        cli->writeChar(cli, digits[--len]);
+    }
 }
 
 static bool isControlChar(char c) {
@@ -0,0 +1,352 @@
+/// @brief  The Embedded-CLI Service, typed command arguments
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// License is noted in the service's LICENSE.txt file (MIT)
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+
+#include "embeddedCliArgs.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include "embeddedCliFormat.hpp"
+#include "embedded_cli.h"
+
+namespace cms {
+namespace EmbeddedCLI {
+
+namespace {
+
+enum class ParseResult : uint8_t {
+    OK,
+    INVALID,
+    OUT_OF_RANGE
+};
+
+bool IsOption(const ArgSpec& spec)
+{
+    return (spec.kind == ArgSpec::Kind::OPTION) || (spec.kind == ArgSpec::Kind::FLAG);
+}
+
+bool IsPositional(const ArgSpec& spec)
+{
+    return !IsOption(spec);
+}
+
+// positional names are shown as <name>, options as they are typed
+void PrintArgProblem(EmbeddedCli* cli, const char* problem, const char* token, const ArgSpec& spec)
+{
+    bool positional = IsPositional(spec);
+    if (token != nullptr)
+    {
+        PrintFormatted(cli, "%s \"%s\" for %s%s%s", problem, token, positional ? "<" : "", spec.name,
+                       positional ? ">" : "");
+    }
+    else
+    {
+        PrintFormatted(cli, "%s %s%s%s", problem, positional ? "<" : "", spec.name, positional ? ">" : "");
+    }
+}
+
+void PrintOutOfRange(EmbeddedCli* cli, const char* token, const ArgSpec& spec)
+{
+    bool positional = IsPositional(spec);
+    const char* format = "Out of range value \"%s\" for %s%s%s, expected %d to %d";
+    if (spec.type == ArgSpec::Type::SIGNED)
+    {
+        PrintFormatted(cli, format, token, positional ? "<" : "", spec.name, positional ? ">" : "",
+                       static_cast<int64_t>(spec.min), static_cast<int64_t>(spec.max));
+    }
+    else
+    {
+        PrintFormatted(cli, format, token, positional ? "<" : "", spec.name, positional ? ">" : "", spec.min,
+                       spec.max);
+    }
+}
+
+// a decimal or 0x prefixed hex magnitude, without sign
+ParseResult ParseMagnitude(const char* text, uint64_t& value)
+{
+    uint64_t base = 10;
+    if ((text[0] == '0') && ((text[1] == 'x') || (text[1] == 'X')))
+    {
+        base = 16;
+        text += 2;
+    }
+
+    if (*text == '\0')
+    {
+        return ParseResult::INVALID;
+    }
+
+    value = 0;
+    bool overflow = false;
+    for (; *text != '\0'; ++text)
+    {
+        char c = *text;
+        uint64_t digit;
+        if ((c >= '0') && (c <= '9'))
+        {
+            digit = static_cast<uint64_t>(c - '0');
+        }
+        else if ((base == 16) && (c >= 'a') && (c <= 'f'))
+        {
+            digit = static_cast<uint64_t>(c - 'a' + 10);
+        }
+        else if ((base == 16) && (c >= 'A') && (c <= 'F'))
+        {
+            digit = static_cast<uint64_t>(c - 'A' + 10);
+        }
+        else
+        {
+            return ParseResult::INVALID;
+        }
+
+        // keep checking the remaining chars, so "99999999999999999999x"
+        // is reported as invalid rather than out of range
+        if (value > (UINT64_MAX - digit) / base)
+        {
+            overflow = true;
+        }
+        value = (value * base) + digit;
+    }
+    return overflow ? ParseResult::OUT_OF_RANGE : ParseResult::OK;
+}
+
+ParseResult ParseInteger(const ArgSpec& spec, const char* text, uint64_t& bits)
+{
+    bool negative = (text[0] == '-');
+    uint64_t magnitude;
+    ParseResult result = ParseMagnitude(negative ? text + 1 : text, magnitude);
+    if (result != ParseResult::OK)
+    {
+        return result;
+    }
+
+    if (spec.type == ArgSpec::Type::UNSIGNED)
+    {
+        if (negative && (magnitude != 0))
+        {
+            return ParseResult::OUT_OF_RANGE;
+        }
+        bits = magnitude;
+        return ((bits < spec.min) || (bits > spec.max)) ? ParseResult::OUT_OF_RANGE : ParseResult::OK;
+    }
+
+    constexpr uint64_t SIGNED_LIMIT = uint64_t(1) << 63;
+    if (magnitude > (negative ? SIGNED_LIMIT : SIGNED_LIMIT - 1))
+    {
+        return ParseResult::OUT_OF_RANGE;
+    }
+    bits = negative ? (uint64_t(0) - magnitude) : magnitude;
+
+    auto value = static_cast<int64_t>(bits);
+    bool inRange = (value >= static_cast<int64_t>(spec.min)) && (value <= static_cast<int64_t>(spec.max));
+    return inRange ? ParseResult::OK : ParseResult::OUT_OF_RANGE;
+}
+
+void StoreInteger(const ArgSpec& spec, void* field, uint64_t bits)
+{
+    // signed fields may be written through their unsigned counterparts
+    switch (spec.size)
+    {
+        case 1:
+            *static_cast<uint8_t*>(field) = static_cast<uint8_t>(bits);
+            break;
+        case 2:
+            *static_cast<uint16_t*>(field) = static_cast<uint16_t>(bits);
+            break;
+        case 4:
+            *static_cast<uint32_t*>(field) = static_cast<uint32_t>(bits);
+            break;
+        default:
+            *static_cast<uint64_t*>(field) = bits;
+            break;
+    }
+}
+
+bool ParseBool(const char* text, bool& value)
+{
+    static constexpr const char* TRUE_WORDS[] = {"1", "true", "on", "yes"};
+    static constexpr const char* FALSE_WORDS[] = {"0", "false", "off", "no"};
+    for (size_t i = 0; i < std::size(TRUE_WORDS); ++i)
+    {
+        if (strcmp(text, TRUE_WORDS[i]) == 0)
+        {
+            value = true;
+            return true;
+        }
+        if (strcmp(text, FALSE_WORDS[i]) == 0)
+        {
+            value = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParseValue(EmbeddedCli* cli, const ArgSpec& spec, const char* token, void* args)
+{
+    void* field = spec.field(args);
+    switch (spec.type)
+    {
+        case ArgSpec::Type::SIGNED:
+        case ArgSpec::Type::UNSIGNED: {
+            uint64_t bits = 0;
+            ParseResult result = ParseInteger(spec, token, bits);
+            if (result == ParseResult::INVALID)
+            {
+                PrintArgProblem(cli, "Invalid number", token, spec);
+                return false;
+            }
+            if (result == ParseResult::OUT_OF_RANGE)
+            {
+                PrintOutOfRange(cli, token, spec);
+                return false;
+            }
+            StoreInteger(spec, field, bits);
+            return true;
+        }
+        case ArgSpec::Type::FLOAT: {
+            char* end = nullptr;
+            double value = strtod(token, &end);
+            if ((end == token) || (*end != '\0'))
+            {
+                PrintArgProblem(cli, "Invalid number", token, spec);
+                return false;
+            }
+            if (spec.size == sizeof(float))
+            {
+                *static_cast<float*>(field) = static_cast<float>(value);
+            }
+            else
+            {
+                *static_cast<double*>(field) = value;
+            }
+            return true;
+        }
+        case ArgSpec::Type::BOOL:
+            if (!ParseBool(token, *static_cast<bool*>(field)))
+            {
+                PrintArgProblem(cli, "Invalid on/off value", token, spec);
+                return false;
+            }
+            return true;
+        case ArgSpec::Type::STRING:
+            *static_cast<const char**>(field) = token;
+            return true;
+    }
+    return false;
+}
+
+const ArgSpec* FindOption(const ArgSpec* specs, size_t count, const char* token)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (IsOption(specs[i]) && (strcmp(specs[i].name, token) == 0))
+        {
+            return &specs[i];
+        }
+    }
+    return nullptr;
+}
+
+const ArgSpec* NextPositional(const ArgSpec* specs, size_t count, size_t& index)
+{
+    for (; index < count; ++index)
+    {
+        if (IsPositional(specs[index]))
+        {
+            return &specs[index++];
+        }
+    }
+    return nullptr;
+}
+
+const char* NextToken(const char* token)
+{
+    // tokens are separated by a single '\0', and end with two
+    const char* next = token + strlen(token) + 1;
+    return (*next != '\0') ? next : nullptr;
+}
+
+} //namespace
+
+bool ParseArgs(EmbeddedCli* cli, const ArgSpec* specs, size_t count, const char* tokens, void* args)
+{
+    size_t nextPositional = 0;
+    const char* token = ((tokens != nullptr) && (tokens[0] != '\0')) ? tokens : nullptr;
+    for (; token != nullptr; token = NextToken(token))
+    {
+        // negative numbers are positional values, unless named as an option
+        const ArgSpec* option = (token[0] == '-') ? FindOption(specs, count, token) : nullptr;
+        if (option != nullptr && option->kind == ArgSpec::Kind::FLAG)
+        {
+            *static_cast<bool*>(option->field(args)) = true;
+            continue;
+        }
+
+        if (option != nullptr)
+        {
+            token = NextToken(token);
+            if (token == nullptr)
+            {
+                PrintArgProblem(cli, "Missing value for", nullptr, *option);
+                return false;
+            }
+            if (!ParseValue(cli, *option, token, args))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        if ((token[0] == '-') && (token[1] == '-'))
+        {
+            PrintFormatted(cli, "Unknown option \"%s\"", token);
+            return false;
+        }
+
+        const ArgSpec* positional = NextPositional(specs, count, nextPositional);
+        if (positional == nullptr)
+        {
+            PrintFormatted(cli, "Unexpected argument \"%s\"", token);
+            return false;
+        }
+        if (!ParseValue(cli, *positional, token, args))
+        {
+            return false;
+        }
+    }
+
+    // positional arguments which were not given must all be optional
+    const ArgSpec* missing;
+    while ((missing = NextPositional(specs, count, nextPositional)) != nullptr)
+    {
+        if (missing->kind == ArgSpec::Kind::POSITIONAL)
+        {
+            PrintArgProblem(cli, "Missing argument", nullptr, *missing);
+            return false;
+        }
+    }
+    return true;
+}
+
+uint16_t TokenizeArgs(char* args, CommandToken* tokens, uint16_t maxTokens)
+{
+    static_assert(sizeof(CliToken) == sizeof(CommandToken), "internal compatibility may have changed");
+    static_assert(offsetof(CliToken, str) == offsetof(CommandToken, str), "internal compatibility may have changed");
+    static_assert(offsetof(CliToken, len) == offsetof(CommandToken, len), "internal compatibility may have changed");
+
+    return embeddedCliTokenizeArgsIndexed(args, reinterpret_cast<CliToken*>(tokens), maxTokens);
+}
+
+} //namespace EmbeddedCLI
+} //namespace cms
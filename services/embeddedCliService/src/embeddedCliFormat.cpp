@@ -0,0 +1,231 @@
+/// @brief  The Embedded-CLI Service, formatted printing
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// License is noted in the service's LICENSE.txt file (MIT)
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+
+#include "embeddedCliFormat.hpp"
+#include "embeddedCliNumberFormat.hpp"
+#include <cstring>
+#include "embedded_cli.h"
+
+namespace cms {
+namespace EmbeddedCLI {
+
+namespace {
+
+struct FormatSpec {
+    bool leftAlign;
+    bool zeroPad;
+    uint16_t width;
+    char conversion;
+};
+
+void WriteRepeated(EmbeddedCli* cli, char c, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        cli->writeChar(cli, c);
+    }
+}
+
+void WriteText(EmbeddedCli* cli, const char* text, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        cli->writeChar(cli, text[i]);
+    }
+}
+
+// writes prefix (a sign or "0x") and body, padded to the spec's width
+void WritePadded(EmbeddedCli* cli, const FormatSpec& spec, const char* prefix, size_t prefixLength,
+                 const char* body, size_t bodyLength)
+{
+    size_t length = prefixLength + bodyLength;
+    size_t padding = (spec.width > length) ? (spec.width - length) : 0;
+
+    if (!spec.leftAlign && !spec.zeroPad)
+    {
+        WriteRepeated(cli, ' ', padding);
+    }
+    WriteText(cli, prefix, prefixLength);
+    if (!spec.leftAlign && spec.zeroPad)
+    {
+        WriteRepeated(cli, '0', padding);
+    }
+    WriteText(cli, body, bodyLength);
+    if (spec.leftAlign)
+    {
+        WriteRepeated(cli, ' ', padding);
+    }
+}
+
+void WriteInteger(EmbeddedCli* cli, const FormatSpec& spec, uint64_t magnitude, bool negative)
+{
+    char digits[DECIMAL_BUFFER_SIZE];
+    size_t length;
+    if ((spec.conversion == 'x') || (spec.conversion == 'X'))
+    {
+        length = FormatHex(magnitude, 1, digits, spec.conversion == 'X');
+    }
+    else
+    {
+        length = FormatDecimal(magnitude, digits);
+    }
+    WritePadded(cli, spec, "-", negative ? 1 : 0, digits, length);
+}
+
+void WriteArg(EmbeddedCli* cli, const FormatSpec& spec, const FormatArg& arg)
+{
+    bool hex = (spec.conversion == 'x') || (spec.conversion == 'X');
+    switch (arg.mType)
+    {
+        case FormatArg::Type::SIGNED:
+            if (spec.conversion == 'c')
+            {
+                char c = static_cast<char>(arg.mSigned);
+                WritePadded(cli, spec, nullptr, 0, &c, 1);
+            }
+            else if (hex)
+            {
+                // as two's complement of the original size, like printf
+                uint64_t mask = (arg.mSize >= sizeof(uint64_t)) ? ~uint64_t(0) : ((uint64_t(1) << (8 * arg.mSize)) - 1);
+                WriteInteger(cli, spec, static_cast<uint64_t>(arg.mSigned) & mask, false);
+            }
+            else if (arg.mSigned < 0)
+            {
+                WriteInteger(cli, spec, uint64_t(0) - static_cast<uint64_t>(arg.mSigned), true);
+            }
+            else
+            {
+                WriteInteger(cli, spec, static_cast<uint64_t>(arg.mSigned), false);
+            }
+            break;
+        case FormatArg::Type::UNSIGNED:
+            if (spec.conversion == 'c')
+            {
+                char c = static_cast<char>(arg.mUnsigned);
+                WritePadded(cli, spec, nullptr, 0, &c, 1);
+            }
+            else
+            {
+                WriteInteger(cli, spec, arg.mUnsigned, false);
+            }
+            break;
+        case FormatArg::Type::CHAR:
+            if ((spec.conversion == 'd') || (spec.conversion == 'i') || (spec.conversion == 'u') || hex)
+            {
+                WriteInteger(cli, spec, static_cast<uint8_t>(arg.mChar), false);
+            }
+            else
+            {
+                WritePadded(cli, spec, nullptr, 0, &arg.mChar, 1);
+            }
+            break;
+        case FormatArg::Type::STRING: {
+            const char* text = (arg.mString != nullptr) ? arg.mString : "(null)";
+            FormatSpec textSpec = spec;
+            textSpec.zeroPad = false;
+            WritePadded(cli, textSpec, nullptr, 0, text, strlen(text));
+            break;
+        }
+        case FormatArg::Type::POINTER: {
+            FormatSpec pointerSpec = spec;
+            pointerSpec.conversion = 'x';
+            char digits[HEX_BUFFER_SIZE];
+            size_t length = FormatHex(reinterpret_cast<uintptr_t>(arg.mPointer), 1, digits);
+            WritePadded(cli, pointerSpec, "0x", 2, digits, length);
+            break;
+        }
+    }
+}
+
+// parses a directive following its '%', returns the char after it
+const char* ParseSpec(const char* format, FormatSpec& spec)
+{
+    spec = FormatSpec{false, false, 0, '\0'};
+    for (;; ++format)
+    {
+        if (*format == '-')
+        {
+            spec.leftAlign = true;
+        }
+        else if (*format == '0')
+        {
+            spec.zeroPad = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    while ((*format >= '0') && (*format <= '9'))
+    {
+        spec.width = static_cast<uint16_t>((spec.width * 10) + (*format - '0'));
+        ++format;
+    }
+
+    // the type of each argument is known, so length is not needed
+    while ((*format == 'h') || (*format == 'l') || (*format == 'z') || (*format == 'j') || (*format == 't'))
+    {
+        ++format;
+    }
+
+    spec.conversion = *format;
+    return (*format != '\0') ? format + 1 : format;
+}
+
+} //namespace
+
+void PrintFormattedArgs(EmbeddedCli* cli, const char* format, const FormatArg* args, size_t argCount)
+{
+    if ((cli == nullptr) || (cli->writeChar == nullptr) || (format == nullptr))
+    {
+        return;
+    }
+
+    embeddedCliPrintBegin(cli);
+
+    size_t nextArg = 0;
+    while (*format != '\0')
+    {
+        if (*format != '%')
+        {
+            cli->writeChar(cli, *format);
+            ++format;
+            continue;
+        }
+
+        const char* directive = format;
+        FormatSpec spec;
+        format = ParseSpec(format + 1, spec);
+
+        if (spec.conversion == '%')
+        {
+            cli->writeChar(cli, '%');
+        }
+        else if ((spec.conversion != '\0') && (nextArg < argCount))
+        {
+            WriteArg(cli, spec, args[nextArg]);
+            ++nextArg;
+        }
+        else
+        {
+            WriteText(cli, directive, static_cast<size_t>(format - directive));
+        }
+    }
+
+    embeddedCliPrintEnd(cli);
+}
+
+} //namespace EmbeddedCLI
+} //namespace cms
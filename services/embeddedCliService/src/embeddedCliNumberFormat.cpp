@@ -0,0 +1,264 @@
+/// @brief  The Embedded-CLI Service, fast number formatting and hexdump
+/// @ingroup
+/// @cond
+///***************************************************************************
+///
+/// License is noted in the service's LICENSE.txt file (MIT)
+///
+/// Contact Information:
+///   Matthew Eshleman
+///   https://covemountainsoftware.com
+///   info@covemountainsoftware.com
+///***************************************************************************
+/// @endcond
+
+#include "embeddedCliNumberFormat.hpp"
+#include <cstring>
+#include "embedded_cli.h"
+
+namespace cms {
+namespace EmbeddedCLI {
+
+namespace {
+
+constexpr size_t MAX_DECIMAL_DIGITS = 20;
+constexpr uint8_t MAX_HEX_DIGITS = 16;
+constexpr size_t HEXDUMP_BYTES_PER_LINE = 16;
+
+// two digits per division, halving the number of divisions
+constexpr char DigitPairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+constexpr char LowerHexDigits[] = "0123456789abcdef";
+constexpr char UpperHexDigits[] = "0123456789ABCDEF";
+
+// writes the digits backwards, ending just before end, returns the first
+char* WriteDigits32(uint32_t value, char* end)
+{
+    while (value >= 100)
+    {
+        uint32_t pair = (value % 100) * 2;
+        value /= 100;
+        *--end = DigitPairs[pair + 1];
+        *--end = DigitPairs[pair];
+    }
+
+    if (value >= 10)
+    {
+        uint32_t pair = value * 2;
+        *--end = DigitPairs[pair + 1];
+        *--end = DigitPairs[pair];
+    }
+    else
+    {
+        *--end = static_cast<char>('0' + value);
+    }
+    return end;
+}
+
+char* WriteDigits64(uint64_t value, char* end)
+{
+    // split off eight digits at a time, until the rest fits 32 bits
+    while (value > UINT32_MAX)
+    {
+        uint32_t lowDigits = static_cast<uint32_t>(value % 100000000u);
+        value /= 100000000u;
+
+        char* groupStart = end - 8;
+        char* pos = WriteDigits32(lowDigits, end);
+        while (pos > groupStart)
+        {
+            *--pos = '0';
+        }
+        end = groupStart;
+    }
+    return WriteDigits32(static_cast<uint32_t>(value), end);
+}
+
+uint64_t Magnitude(int64_t value)
+{
+    return (value < 0) ? (uint64_t(0) - static_cast<uint64_t>(value)) : static_cast<uint64_t>(value);
+}
+
+void WriteHexByte(EmbeddedCli* cli, uint8_t value)
+{
+    cli->writeChar(cli, LowerHexDigits[value >> 4]);
+    cli->writeChar(cli, LowerHexDigits[value & 0xFu]);
+}
+
+void WriteHexDumpLine(EmbeddedCli* cli, const uint8_t* bytes, size_t count, uintptr_t address,
+                      uint8_t addressDigits)
+{
+    char addressText[HEX_BUFFER_SIZE];
+    size_t addressLength = FormatHex(address, addressDigits, addressText);
+    for (size_t i = 0; i < addressLength; ++i)
+    {
+        cli->writeChar(cli, addressText[i]);
+    }
+    cli->writeChar(cli, ' ');
+
+    for (size_t i = 0; i < HEXDUMP_BYTES_PER_LINE; ++i)
+    {
+        if ((i % 8) == 0)
+        {
+            cli->writeChar(cli, ' ');
+        }
+
+        if (i < count)
+        {
+            WriteHexByte(cli, bytes[i]);
+        }
+        else
+        {
+            // keep the ascii column aligned on the last line
+            cli->writeChar(cli, ' ');
+            cli->writeChar(cli, ' ');
+        }
+        cli->writeChar(cli, ' ');
+    }
+
+    cli->writeChar(cli, ' ');
+    cli->writeChar(cli, '|');
+    for (size_t i = 0; i < count; ++i)
+    {
+        bool printable = (bytes[i] >= 0x20) && (bytes[i] < 0x7F);
+        cli->writeChar(cli, printable ? static_cast<char>(bytes[i]) : '.');
+    }
+    cli->writeChar(cli, '|');
+}
+
+} //namespace
+
+size_t FormatDecimal(uint64_t value, char* dest)
+{
+    char digits[MAX_DECIMAL_DIGITS];
+    char* end = &digits[MAX_DECIMAL_DIGITS];
+    char* start = WriteDigits64(value, end);
+
+    size_t length = static_cast<size_t>(end - start);
+    memcpy(dest, start, length);
+    dest[length] = '\0';
+    return length;
+}
+
+size_t FormatSignedDecimal(int64_t value, char* dest)
+{
+    if (value < 0)
+    {
+        dest[0] = '-';
+        return 1 + FormatDecimal(Magnitude(value), dest + 1);
+    }
+    return FormatDecimal(static_cast<uint64_t>(value), dest);
+}
+
+size_t FormatHex(uint64_t value, uint8_t minDigits, char* dest, bool upperCase)
+{
+    const char* hexDigits = upperCase ? UpperHexDigits : LowerHexDigits;
+
+    size_t count = 1;
+    for (uint64_t rest = value >> 4; rest != 0; rest >>= 4)
+    {
+        ++count;
+    }
+
+    if (minDigits > MAX_HEX_DIGITS)
+    {
+        minDigits = MAX_HEX_DIGITS;
+    }
+    if (count < minDigits)
+    {
+        count = minDigits;
+    }
+
+    for (size_t i = count; i > 0; --i)
+    {
+        dest[i - 1] = hexDigits[value & 0xFu];
+        value >>= 4;
+    }
+    dest[count] = '\0';
+    return count;
+}
+
+size_t FormatFixedPoint(int64_t scaledValue, uint8_t fractionDigits, char* dest)
+{
+    if (fractionDigits > MAX_FRACTION_DIGITS)
+    {
+        fractionDigits = MAX_FRACTION_DIGITS;
+    }
+
+    char digits[MAX_DECIMAL_DIGITS];
+    char* end = &digits[MAX_DECIMAL_DIGITS];
+    char* start = WriteDigits64(Magnitude(scaledValue), end);
+    size_t digitCount = static_cast<size_t>(end - start);
+
+    size_t length = 0;
+    if (scaledValue < 0)
+    {
+        dest[length++] = '-';
+    }
+
+    if (fractionDigits == 0)
+    {
+        memcpy(&dest[length], start, digitCount);
+        length += digitCount;
+    }
+    else if (digitCount > fractionDigits)
+    {
+        size_t integerDigits = digitCount - fractionDigits;
+        memcpy(&dest[length], start, integerDigits);
+        length += integerDigits;
+        dest[length++] = '.';
+        memcpy(&dest[length], start + integerDigits, fractionDigits);
+        length += fractionDigits;
+    }
+    else
+    {
+        dest[length++] = '0';
+        dest[length++] = '.';
+        size_t leadingZeros = fractionDigits - digitCount;
+        memset(&dest[length], '0', leadingZeros);
+        length += leadingZeros;
+        memcpy(&dest[length], start, digitCount);
+        length += digitCount;
+    }
+
+    dest[length] = '\0';
+    return length;
+}
+
+void PrintHexDump(EmbeddedCli* cli, const void* data, size_t length, uintptr_t displayAddress)
+{
+    if ((cli == nullptr) || (cli->writeChar == nullptr) || (data == nullptr) || (length == 0))
+    {
+        return;
+    }
+
+    uint64_t lastAddress = static_cast<uint64_t>(displayAddress) + (length - 1);
+    uint8_t addressDigits = (lastAddress > UINT32_MAX) ? 16 : 8;
+
+    auto bytes = static_cast<const uint8_t*>(data);
+    for (size_t offset = 0; offset < length; offset += HEXDUMP_BYTES_PER_LINE)
+    {
+        size_t count = length - offset;
+        if (count > HEXDUMP_BYTES_PER_LINE)
+        {
+            count = HEXDUMP_BYTES_PER_LINE;
+        }
+
+        embeddedCliPrintBegin(cli);
+        WriteHexDumpLine(cli, &bytes[offset], count, displayAddress + offset, addressDigits);
+        embeddedCliPrintEnd(cli);
+    }
+}
+
+} //namespace EmbeddedCLI
+} //namespace cms
@@ -14,6 +14,8 @@
 
 #include "embeddedCliService.hpp"
 #include "cms_pubsub.hpp"
+#include <cstddef>
+#include <cstring>
 #include "qsafe.h"
 #include "embedded_cli.h"
 
@@ -22,9 +24,37 @@ Q_DEFINE_THIS_MODULE("EmbeddedCliService")
 namespace cms {
 namespace EmbeddedCLI {
 
-Service::Service(CliUint * buffer, size_t bufferElementCount, uint16_t maxBindingCount, const char * customInvitation) :
+Service::Service(CliUint * buffer, size_t bufferElementCount, uint16_t maxBindingCount, const char * customInvitation,
+                 RenderProfile profile) :
     QP::QActive(initial),
     mCharacterDevice(nullptr),
+    mRxRing(),
+    mRxDoorbellArmed(true),
+    mOverloadPolicy(OverloadPolicy::MARK_LINE_CORRUPT),
+    mRxDroppedBytes(0),
+    mRxLossPosition(0),
+    mRxDroppedBytesHandled(0),
+    mRxDiscardingLine(false),
+    mRxFlowStopped(false),
+    mRxFlowPending(false),
+    mRxFlowPendingStop(false),
+    mTxRing(),
+    mTxHead(0),
+    mTxTail(0),
+    mTxDroppedBytes(0),
+    mDroppedPrints(0),
+    mBulkRing(),
+    mBulkOutputBudget(CMS_EMBEDDED_CLI_TX_RING_SIZE / 4),
+    mCommandLineOpen(false),
+    mPagerLines(0),
+    mPageLineCount(0),
+    mPagerWaiting(false),
+    mPagedOutput(false),
+    mTxReadyArmed(false),
+    mTxReadyMissed(false),
+    mTxRetryTimer(this, TX_RETRY_SIG, 0U),
+    mTxRetryPending(false),
+    mTxStalled(false),
     mEmbeddedCliConfigBacking(),
     mEmbeddedCliConfig(reinterpret_cast<EmbeddedCliConfig*>(mEmbeddedCliConfigBacking.data())),
     mEmbeddedCli(nullptr),
@@ -50,6 +80,13 @@ Service::Service(CliUint * buffer, size_t bufferElementCount, uint16_t maxBindin
         mEmbeddedCliConfig->maxBindingCount = maxBindingCount;
     }
 
+    mEmbeddedCliConfig->maxBindingTableCount = CMS_EMBEDDED_CLI_MAX_BINDING_TABLES;
+
+    if (profile == RenderProfile::LOW_BANDWIDTH) {
+        mEmbeddedCliConfig->enableAutoComplete = false;
+        mEmbeddedCliConfig->enableShortCursorMoves = true;
+    }
+
     // After all configuration items have been set,
     // make sure our static buffer is large enough, but
     // only if we are using that option.
@@ -100,9 +137,31 @@ Q_STATE_DEF(Service, inactive)
         }
             break;
         case ADD_CLI_BINDING_SIG:
+        case ADD_CLI_BINDING_TABLE_SIG:
             Q_ASSERT(false);
             rtn = Q_RET_HANDLED;
             break;
+        case TX_READY_SIG:
+        case TX_RETRY_SIG:
+            //late notification from a prior session, nothing to write
+            rtn = Q_RET_HANDLED;
+            break;
+        case PRINT_SIG:
+            //no CLI to print to, discard the text
+            rtn = Q_RET_HANDLED;
+            break;
+        case NEW_CLI_DATA_SIG: {
+            //stale data from a prior session, discard it
+            mRxDoorbellArmed = true;
+            std::array<uint8_t, RX_DRAIN_CHUNK_SIZE> discard;
+            size_t discarded;
+            do {
+                discarded = mRxRing.Pop(discard.data(), discard.size());
+            } while (discarded > 0);
+            mRxDroppedBytesHandled = mRxDroppedBytes.load();
+            rtn = Q_RET_HANDLED;
+            break;
+        }
         case END_CLI_SIG:
             //nothing to do, already inactive
             rtn = Q_RET_HANDLED;
@@ -120,13 +179,37 @@ Q_STATE_DEF(Service, active)
     QP::QState rtn;
     switch (e->sig) {
         case Q_ENTRY_SIG: {
-            mCharacterDevice->RegisterNewByteCallback(NewByteReceived, this);
+            if (!mCharacterDevice->RegisterNewBytesCallback(NewBytesReceived, this))
+            {
+                mCharacterDevice->RegisterNewByteCallback(NewByteReceived, this);
+            }
+            mCharacterDevice->RegisterWriteReadyCallback(WriteReady, this);
             mEmbeddedCli = embeddedCliNew(mEmbeddedCliConfig);
             Q_ASSERT(mEmbeddedCli != nullptr);
 
             mEmbeddedCli->appContext = this;
             mEmbeddedCli->writeChar = &Service::CliWriteChar;
+            mRxDiscardingLine = false;
+            mRxFlowStopped = false;
+            mRxFlowPending = false;
+            mTxHead = 0;
+            mTxTail = 0;
+            mTxReadyArmed = false;
+            mTxReadyMissed = false;
+            mTxStalled = false;
+            mCommandLineOpen = false;
+            mPageLineCount = 0;
+            mPagerWaiting = false;
+            mPagedOutput = false;
+            {
+                //command output left over from a prior session
+                std::array<uint8_t, RX_DRAIN_CHUNK_SIZE> discard;
+                while (mBulkRing.Pop(discard.data(), discard.size()) > 0)
+                {
+                }
+            }
             embeddedCliProcess(mEmbeddedCli);
+            ScheduleOutput();
             QP::QF::PUBLISH(&mActiveEvent, this);
             rtn = Q_RET_HANDLED;
             break;
@@ -135,10 +218,35 @@ Q_STATE_DEF(Service, active)
             //we are already active, drop this Begin request
             rtn = Q_RET_HANDLED;
             break;
-        case NEW_CLI_DATA_SIG: {
-            auto dataEvent = reinterpret_cast<const NewDataEvent*>(e);
-            embeddedCliReceiveChar(mEmbeddedCli, static_cast<char>(dataEvent->mByte));
-            embeddedCliProcess(mEmbeddedCli);
+        case NEW_CLI_DATA_SIG:
+            DrainReceivedBytes();
+            rtn = Q_RET_HANDLED;
+            break;
+        case TX_RETRY_SIG:
+            mTxRetryPending = false;
+            // fall through
+        case TX_READY_SIG:
+            ScheduleOutput();
+            //resume any input held back while output was blocked
+            if (mRxRing.Count() > 0)
+            {
+                DrainReceivedBytes();
+            }
+            rtn = Q_RET_HANDLED;
+            break;
+        case PRINT_SIG: {
+            auto printEvent = reinterpret_cast<const PrintEvent*>(e);
+            //printed above the pager's prompt, like above an edited line
+            if (mPagerWaiting)
+            {
+                WritePagerText(PAGER_ERASE);
+            }
+            embeddedCliPrint(mEmbeddedCli, printEvent->mText);
+            if (mPagerWaiting)
+            {
+                ShowPagerPrompt();
+            }
+            ScheduleOutput();
             rtn = Q_RET_HANDLED;
             break;
         }
@@ -153,23 +261,98 @@ Q_STATE_DEF(Service, active)
             binding.name = addBindingEvent->mBinding.name;
             binding.help = addBindingEvent->mBinding.help;
             binding.tokenizeArgs = addBindingEvent->mBinding.tokenizeArgs;
+            binding.subcommands = reinterpret_cast<const CliBindingTable*>(addBindingEvent->mBinding.subcommands);
             bool ok = embeddedCliAddBinding(mEmbeddedCli, binding);
             Q_ASSERT(ok);
             embeddedCliProcess(mEmbeddedCli);
+            ScheduleOutput();
+            rtn = Q_RET_HANDLED;
+            break;
+        }
+        case ADD_CLI_BINDING_TABLE_SIG: {
+            auto addTableEvent = reinterpret_cast<const AddCliBindingTableEvent*>(e);
+
+            //the table is referenced in place, so unlike single bindings
+            //above, the layouts must match exactly.
+            static_assert(sizeof(CliCommandBinding) == sizeof(CommandBinding), "internal compatibility may have changed");
+            static_assert(offsetof(CliCommandBinding, name) == offsetof(CommandBinding, name), "internal compatibility may have changed");
+            static_assert(offsetof(CliCommandBinding, help) == offsetof(CommandBinding, help), "internal compatibility may have changed");
+            static_assert(offsetof(CliCommandBinding, tokenizeArgs) == offsetof(CommandBinding, tokenizeArgs), "internal compatibility may have changed");
+            static_assert(offsetof(CliCommandBinding, context) == offsetof(CommandBinding, context), "internal compatibility may have changed");
+            static_assert(offsetof(CliCommandBinding, binding) == offsetof(CommandBinding, binding), "internal compatibility may have changed");
+            static_assert(offsetof(CliCommandBinding, subcommands) == offsetof(CommandBinding, subcommands), "internal compatibility may have changed");
+            static_assert(sizeof(CliBindingTable) == sizeof(CommandBindingTable), "internal compatibility may have changed");
+            static_assert(offsetof(CliBindingTable, bindings) == offsetof(CommandBindingTable, bindings), "internal compatibility may have changed");
+            static_assert(offsetof(CliBindingTable, count) == offsetof(CommandBindingTable, count), "internal compatibility may have changed");
+            static_assert(offsetof(CliBindingTable, hash) == offsetof(CommandBindingTable, hash), "internal compatibility may have changed");
+            static_assert(sizeof(CliBindingHash) == sizeof(CommandBindingHash), "internal compatibility may have changed");
+            static_assert(offsetof(CliBindingHash, slots) == offsetof(CommandBindingHash, slots), "internal compatibility may have changed");
+            static_assert(offsetof(CliBindingHash, displacements) == offsetof(CommandBindingHash, displacements), "internal compatibility may have changed");
+            static_assert(offsetof(CliBindingHash, slotCount) == offsetof(CommandBindingHash, slotCount), "internal compatibility may have changed");
+            static_assert(offsetof(CliBindingHash, bucketCount) == offsetof(CommandBindingHash, bucketCount), "internal compatibility may have changed");
+            static_assert(offsetof(CliBindingHash, seed) == offsetof(CommandBindingHash, seed), "internal compatibility may have changed");
+
+            auto table = reinterpret_cast<const CliBindingTable*>(&addTableEvent->mTable);
+            bool ok = embeddedCliAddBindingTable(mEmbeddedCli, table);
+            Q_ASSERT(ok);
+            embeddedCliProcess(mEmbeddedCli);
+            ScheduleOutput();
             rtn = Q_RET_HANDLED;
             break;
         }
         case END_CLI_SIG:
+            //do not leave the remote sender paused
+            if (mRxFlowStopped)
+            {
+                SetReceiveFlowControl(cms::interfaces::CharacterDevice::FlowControl::GO);
+            }
             rtn = tran(&inactive);
             break;
+        case Q_EXIT_SIG:
+            mTxRetryTimer.disarm();
+            mTxRetryPending = false;
+            rtn = Q_RET_HANDLED;
+            break;
         default:
             rtn = super(&top);
             break;
     }
 
+    if ((rtn == Q_RET_HANDLED) && (e->sig != Q_EXIT_SIG))
+    {
+        CompleteStep();
+    }
+
     return rtn;
 }
 
+void Service::CompleteStep()
+{
+    // a doorbell which could not be posted, because the AO's queue
+    // was congested, is made up for here. The queue only congests
+    // with events for this AO, so this runs soon after the failed
+    // post, even if no more bytes are ever received.
+    if (mRxDoorbellArmed.load() && (mRxRing.Count() > 0))
+    {
+        DrainReceivedBytes();
+    }
+
+    // likewise for a write ready notification
+    if (mTxReadyMissed.exchange(false))
+    {
+        ScheduleOutput();
+    }
+
+    // output still refused by the device is retried after a while,
+    // for devices without a write ready callback, or should the
+    // callback's TX_READY_SIG not get through.
+    if (mTxReadyArmed.load() && !mTxRetryPending)
+    {
+        mTxRetryTimer.armX(CMS_EMBEDDED_CLI_TX_RETRY_TICKS);
+        mTxRetryPending = true;
+    }
+}
+
 void Service::BeginCliAsync(cms::interfaces::CharacterDevice* charDevice)
 {
     Q_ASSERT(charDevice != nullptr);
@@ -186,20 +369,149 @@ void Service::EndCliAsync()
 
 void Service::AddCliBindingAsync(const CommandBinding& binding)
 {
-    Q_ASSERT(binding.binding != nullptr);
+    Q_ASSERT((binding.binding != nullptr) || (binding.subcommands != nullptr));
     Q_ASSERT(binding.name != nullptr);
     auto e = Q_NEW(AddCliBindingEvent, ADD_CLI_BINDING_SIG);
     e->mBinding = binding;
     this->POST(e, 0);
 }
 
+void Service::AddCliBindingTableAsync(const CommandBindingTable& table)
+{
+    Q_ASSERT(table.bindings != nullptr);
+    auto e = Q_NEW(AddCliBindingTableEvent, ADD_CLI_BINDING_TABLE_SIG);
+    e->mTable = table;
+    this->POST(e, 0);
+}
+
+void Service::AddCliBindingsAsync(const CommandBinding* bindings, uint16_t count)
+{
+    AddCliBindingTableAsync(CommandBindingTable{bindings, count, nullptr});
+}
+
+bool Service::PrintAsync(const char* text)
+{
+    Q_ASSERT(text != nullptr);
+    size_t length = strlen(text);
+    if (length < sizeof(SmallPrintEvent::mBuffer))
+    {
+        return PostPrintText<SmallPrintEvent>(text, length);
+    }
+    else if (length < sizeof(MediumPrintEvent::mBuffer))
+    {
+        return PostPrintText<MediumPrintEvent>(text, length);
+    }
+    else
+    {
+        return PostPrintText<LargePrintEvent>(text, length);
+    }
+}
+
+bool Service::PrintStaticAsync(const char* text)
+{
+    Q_ASSERT(text != nullptr);
+    auto e = Q_NEW_X(PrintEvent, PRINT_EVENT_POOL_MARGIN, PRINT_SIG);
+    if (e == nullptr)
+    {
+        CountDroppedPrint();
+        return false;
+    }
+    e->mText = text;
+    return PostPrint(e);
+}
+
+template <class PrintTextEventType>
+bool Service::PostPrintText(const char* text, size_t length)
+{
+    auto e = Q_NEW_X(PrintTextEventType, PRINT_EVENT_POOL_MARGIN, PRINT_SIG);
+    if (e == nullptr)
+    {
+        CountDroppedPrint();
+        return false;
+    }
+    if (length >= sizeof(e->mBuffer))
+    {
+        length = sizeof(e->mBuffer) - 1;
+    }
+    memcpy(e->mBuffer, text, length);
+    e->mBuffer[length] = '\0';
+    //the event is never copied, so it may point into itself
+    e->mText = e->mBuffer;
+    return PostPrint(e);
+}
+
+bool Service::PostPrint(const PrintEvent* e)
+{
+    // printing may be requested from any active object, at any rate,
+    // so it never takes the last of the AO's queue. An event which
+    // is not posted is recycled by QF.
+    if (!this->POST_X(e, PRINT_QUEUE_MARGIN, this))
+    {
+        CountDroppedPrint();
+        return false;
+    }
+    return true;
+}
+
+void Service::CountDroppedPrint()
+{
+    // active objects of any priority may print, preempting each other
+    mDroppedPrints.fetch_add(1);
+}
+
 void Service::CliWriteChar(EmbeddedCli *embeddedCli, char c)
 {
     auto me = static_cast<Service*>(embeddedCli->appContext);
 
     if ((me != nullptr) && (me->mCharacterDevice != nullptr))
     {
-        me->mCharacterDevice->WriteAsync(static_cast<uint8_t>(c));
+        // command output only goes straight to the transmit ring
+        // within its share, and never ahead of older command output.
+        // A line already started is completed, so that keystroke echo
+        // never lands in the middle of it. Paged output beyond the end
+        // of the page is held back too, even within a single call of
+        // its producer. The rest waits in the bulk ring, see
+        // ReleaseBulkOutput().
+        bool commandOutput = embeddedCliIsCommandRunning(embeddedCli);
+        bool pageFull = me->mPagedOutput && (me->mPageLineCount >= me->mPagerLines);
+        if (!commandOutput && !me->mPagedOutput)
+        {
+            me->mPageLineCount = 0;
+        }
+
+        if (commandOutput && (pageFull || (me->mBulkRing.Count() > 0) ||
+            (!me->mCommandLineOpen && (me->PendingOutput() >= me->mBulkOutputBudget))))
+        {
+            uint8_t byte = static_cast<uint8_t>(c);
+            while (me->mBulkRing.Push(&byte, 1) == 0)
+            {
+                // a producer writing more than the bulk ring holds
+                // beyond the page overruns the page, rather than
+                // waiting for a key which is never read.
+                if (pageFull && !me->mPagerWaiting)
+                {
+                    me->mPageLineCount = 0;
+                }
+
+                // the command is writing faster than the device
+                // accepts output.
+                if (!me->WaitForOutputRoom())
+                {
+                    me->mTxDroppedBytes.fetch_add(1);
+                    break;
+                }
+            }
+            return;
+        }
+
+        if (me->PutOutput(static_cast<uint8_t>(c)))
+        {
+            me->mCommandLineOpen = commandOutput && (c != '\n');
+            if (commandOutput && (c == '\n'))
+            {
+                ++me->mPageLineCount;
+            }
+        }
     }
     else
     {
@@ -208,33 +520,621 @@ void Service::CliWriteChar(EmbeddedCli *embeddedCli, char c)
     }
 }
 
+bool Service::PutOutput(uint8_t byte)
+{
+    // output is collected and written once per event, rather
+    // than a byte at a time. Only very long output, such as a
+    // help listing, is written in several blocks.
+    while (PendingOutput() == mTxRing.size())
+    {
+        if (!WaitForOutputRoom())
+        {
+            mTxDroppedBytes.fetch_add(1);
+            return false;
+        }
+    }
+
+    mTxRing[mTxHead & (mTxRing.size() - 1)] = byte;
+    ++mTxHead;
+    return true;
+}
+
+bool Service::WaitForOutputRoom()
+{
+    // output which does not fit the rings waits for the device, as
+    // it would with a blocking write, rather than being dropped. So
+    // the AO is never stuck, a device which accepts nothing at all
+    // for a long while is given up on.
+    uint32_t attempts = 0;
+    while (!mTxStalled)
+    {
+        uint16_t tail = mTxTail;
+        size_t bulk = mBulkRing.Count();
+        FlushOutput();
+        if (embeddedCliIsCommandRunning(mEmbeddedCli))
+        {
+            ReleaseBulkOutput();
+        }
+
+        if ((mTxTail != tail) || (mBulkRing.Count() != bulk))
+        {
+            return true;
+        }
+
+        if (++attempts >= CMS_EMBEDDED_CLI_TX_STALL_RETRIES)
+        {
+            mTxStalled = true;
+        }
+    }
+    return false;
+}
+
+void Service::SetBulkOutputShare(uint8_t percent)
+{
+    Q_ASSERT((percent > 0) && (percent <= 100));
+    mBulkOutputBudget = (mTxRing.size() * percent) / 100;
+    mBulkOutputBudget = (mBulkOutputBudget > 0) ? mBulkOutputBudget : 1;
+}
+
+void Service::ScheduleOutput()
+{
+    FlushOutput();
+    ReleaseBulkOutput();
+    ProduceOutput();
+}
+
+void Service::ProduceOutput()
+{
+    // output produced lazily by a command, e.g. the help listing,
+    // is produced only as its share of the transmit ring has room,
+    // so it is neither buffered in full nor blocks the AO. The
+    // device's write ready callback, or the retry timer, resumes
+    // production. The pager stops it at the end of each page, and
+    // holds back the rest of that producer call's output.
+    while (!mPagerWaiting)
+    {
+        if (mBulkRing.Count() > 0)
+        {
+            ReleaseBulkOutput();
+            if (mPagerWaiting || (mBulkRing.Count() > 0))
+            {
+                break;
+            }
+        }
+
+        if (!embeddedCliIsOutputPending(mEmbeddedCli))
+        {
+            break;
+        }
+
+        if (PendingOutput() >= mBulkOutputBudget)
+        {
+            FlushOutput();
+            if (PendingOutput() >= mBulkOutputBudget)
+            {
+                break;
+            }
+        }
+
+        if ((mPagerLines > 0) && (mPageLineCount >= mPagerLines))
+        {
+            ShowPagerPrompt();
+            break;
+        }
+
+        mPagedOutput = (mPagerLines > 0);
+        if (!embeddedCliProduceOutput(mEmbeddedCli))
+        {
+            // input received along with the command waited in
+            // the embedded-cli, and is processed now.
+            embeddedCliProcess(mEmbeddedCli);
+        }
+    }
+
+    FlushOutput();
+}
+
+bool Service::HandlePagerKey()
+{
+    uint8_t key;
+    if (mRxRing.Pop(&key, 1) == 0)
+    {
+        return false;
+    }
+
+    // the line feed of a received CR LF pair is part of the same key
+    uint8_t next;
+    if ((key == '\r') && (mRxRing.Peek(&next, 1) == 1) && (next == '\n'))
+    {
+        mRxRing.Pop(&next, 1);
+    }
+
+    WritePagerText(PAGER_ERASE);
+    mPagerWaiting = false;
+    mPageLineCount = 0;
+    if ((key == 'q') || (key == 'Q') || (key == ETX))
+    {
+        // along with any output held back for the next page
+        std::array<uint8_t, BULK_CHUNK_SIZE> discard;
+        while (mBulkRing.Pop(discard.data(), discard.size()) > 0)
+        {
+        }
+        mPagedOutput = false;
+
+        if (embeddedCliIsOutputPending(mEmbeddedCli))
+        {
+            embeddedCliCancelOutput(mEmbeddedCli);
+            embeddedCliProcess(mEmbeddedCli);
+        }
+        else
+        {
+            // the invitation, replaced by the prompt, is drawn again
+            embeddedCliPrintEndRaw(mEmbeddedCli);
+        }
+    }
+    return true;
+}
+
+void Service::ShowPagerPrompt()
+{
+    // once the command is done, the prompt takes the place of the
+    // invitation drawn after its output, which is drawn again
+    // after the next page.
+    if (!embeddedCliIsCommandRunning(mEmbeddedCli))
+    {
+        WritePagerText(PAGER_ERASE);
+    }
+    WritePagerText(PAGER_PROMPT);
+    mPagerWaiting = true;
+}
+
+void Service::WritePagerText(const char* text)
+{
+    // written straight to the transmit ring, ahead of any
+    // output held back for the next page.
+    while (*text != '\0')
+    {
+        PutOutput(static_cast<uint8_t>(*text));
+        ++text;
+    }
+}
+
+void Service::ReleaseBulkOutput()
+{
+    // command output which did not fit its share of the transmit
+    // ring is moved on, unchanged, as the character device catches
+    // up. Once the command is done, it is written above the line
+    // being edited, complete lines at a time, which is cleared and
+    // drawn again like any embeddedCliPrint(). Paged output is
+    // released a page at a time.
+    std::array<uint8_t, BULK_CHUNK_SIZE> chunk;
+    while ((mBulkRing.Count() > 0) && !mPagerWaiting)
+    {
+        if (mPagedOutput && (mPageLineCount >= mPagerLines))
+        {
+            ShowPagerPrompt();
+            break;
+        }
+
+        bool commandRunning = embeddedCliIsCommandRunning(mEmbeddedCli);
+        size_t maxLength = (mBulkOutputBudget < chunk.size()) ? mBulkOutputBudget : chunk.size();
+        size_t room = (PendingOutput() < mBulkOutputBudget) ? (mBulkOutputBudget - PendingOutput()) : 0;
+        size_t length = mBulkRing.Peek(chunk.data(), (room < maxLength) ? room : maxLength);
+
+        // a running command's output continues where it is, while
+        // the edited line is only drawn again after a complete line.
+        // A line which can never fit, the rest of a line already
+        // started, or the final output without a line break, is
+        // written as is.
+        size_t lineEnd = length;
+        if (!commandRunning)
+        {
+            while ((lineEnd > 0) && (chunk[lineEnd - 1] != '\n'))
+            {
+                --lineEnd;
+            }
+            if ((lineEnd == 0) && (mCommandLineOpen || (length == maxLength) || (length == mBulkRing.Count())))
+            {
+                lineEnd = length;
+            }
+        }
+
+        if (lineEnd == 0)
+        {
+            // wait for room. Resumed upon TX_READY_SIG, which is
+            // armed for as long as output is refused, or TX_RETRY_SIG.
+            FlushOutput();
+            if (PendingOutput() > 0)
+            {
+                return;
+            }
+            continue;
+        }
+
+        if (mPagedOutput)
+        {
+            // up to the end of the page
+            size_t lines = mPageLineCount;
+            for (size_t i = 0; i < lineEnd; ++i)
+            {
+                if ((chunk[i] == '\n') && (++lines == mPagerLines))
+                {
+                    lineEnd = i + 1;
+                    break;
+                }
+            }
+        }
+
+        if (!commandRunning && !mCommandLineOpen)
+        {
+            embeddedCliPrintBegin(mEmbeddedCli);
+        }
+
+        // clearing the line may have used the last of the ring
+        size_t space = mTxRing.size() - PendingOutput();
+        lineEnd = (space < lineEnd) ? space : lineEnd;
+        if (lineEnd == 0)
+        {
+            continue;
+        }
+
+        mBulkRing.Pop(chunk.data(), lineEnd);
+        for (size_t i = 0; i < lineEnd; ++i)
+        {
+            mTxRing[mTxHead & (mTxRing.size() - 1)] = chunk[i];
+            ++mTxHead;
+            if (chunk[i] == '\n')
+            {
+                ++mPageLineCount;
+            }
+        }
+        mCommandLineOpen = (chunk[lineEnd - 1] != '\n');
+
+        if (!commandRunning && (!mCommandLineOpen || (mBulkRing.Count() == 0)))
+        {
+            // as the output was followed by the invitation
+            embeddedCliPrintEndRaw(mEmbeddedCli);
+            mCommandLineOpen = false;
+        }
+    }
+
+    if ((mBulkRing.Count() == 0) && !embeddedCliIsOutputPending(mEmbeddedCli))
+    {
+        mPagedOutput = false;
+    }
+
+    FlushOutput();
+}
+
+void Service::WriteReady(void* userData)
+{
+    // This character device callback event could happen from
+    // any thread or ISR context. Like receiving, a static
+    // 'doorbell' event is posted only when the AO is waiting.
+    static const QP::QEvt writeReadyEvent = QP::QEvt(TX_READY_SIG);
+
+    auto me = static_cast<Service*>(userData);
+    if (me != nullptr)
+    {
+        if (me->mTxReadyArmed.load())
+        {
+            me->mTxReadyArmed.store(false);
+            if (!me->POST_X(&writeReadyEvent, RX_DOORBELL_QUEUE_MARGIN, me))
+            {
+                // the AO's queue is congested, so the AO catches up
+                // once done with its current event, see CompleteStep().
+                me->mTxReadyArmed.store(true);
+                me->mTxReadyMissed.store(true);
+            }
+        }
+    }
+    else
+    {
+        Q_ASSERT(userData != nullptr);
+    }
+}
+
+void Service::FlushOutput()
+{
+    // armed before writing, so that a device becoming ready during
+    // the write still notifies the AO. At worst, a needless
+    // TX_READY_SIG is handled.
+    mTxReadyArmed.store(true);
+
+    if (mRxFlowPending)
+    {
+        SetReceiveFlowControl(mRxFlowPendingStop ? cms::interfaces::CharacterDevice::FlowControl::STOP
+                                                 : cms::interfaces::CharacterDevice::FlowControl::GO);
+        if (mRxFlowPending)
+        {
+            return;
+        }
+    }
+
+    while (PendingOutput() > 0)
+    {
+        // the device is handed the contiguous bytes up to the
+        // end of the ring, then the wrapped remainder.
+        size_t tail = mTxTail & (mTxRing.size() - 1);
+        size_t length = mTxRing.size() - tail;
+        length = (PendingOutput() < length) ? PendingOutput() : length;
+
+        size_t written = mCharacterDevice->WriteAsync(&mTxRing[tail], length);
+        mTxTail = static_cast<uint16_t>(mTxTail + written);
+        mTxStalled = mTxStalled && (written == 0);
+        if (written < length)
+        {
+            // retried upon the device's write ready callback, if
+            // supported, or the retry timer, see CompleteStep().
+            return;
+        }
+    }
+
+    mTxReadyArmed.store(false);
+}
+
 void Service::NewByteReceived(void* userData, uint8_t byte)
+{
+    // Adapter for character devices which only support
+    // a per-byte receive callback.
+    NewBytesReceived(userData, &byte, 1);
+}
+
+void Service::NewBytesReceived(void* userData, const uint8_t* bytes, size_t length)
 {
     // This character device callback event could happen from
     // any thread or ISR context.
     //
     // In theory, the embedded-cli code supports incoming chars
     // from an ISR context. However, for maximum portability,
-    // I'm going to just copy this byte and send it to the AO
-    // for processing, mainly because the embedded-cli docs say:
+    // I'm going to just copy these bytes and let the AO
+    // process them, mainly because the embedded-cli docs say:
     //
     //    "embeddedCliReceiveChar() can be called from normal code or
     //     from ISRs (but don't call it from multiple places)."
     //
     // That bit about not calling from multiple places gave me
-    // pause. So, for maximum paranoia, will copy and send the
-    // byte to the AO for processing.
+    // pause. So, for maximum paranoia, the bytes are copied into
+    // a wait-free ring owned by this service, and a static
+    // 'doorbell' event is posted only when the AO is not already
+    // due to drain the ring. No event pool is involved.
+
+    static const QP::QEvt dataReadyEvent = QP::QEvt(NEW_CLI_DATA_SIG);
 
     auto me = static_cast<Service*>(userData);
-    if (me != nullptr)
+    if ((me != nullptr) && (bytes != nullptr))
     {
-        auto e = Q_NEW(NewDataEvent, NEW_CLI_DATA_SIG);
-        e->mByte = byte;
-        me->POST(e, 0);
+        me->ReceiveIntoRing(bytes, length);
+
+        if (me->mRxDoorbellArmed.load())
+        {
+            me->mRxDoorbellArmed.store(false);
+            if (!me->POST_X(&dataReadyEvent, RX_DOORBELL_QUEUE_MARGIN, me))
+            {
+                // the AO's queue is congested. The bytes remain in
+                // the ring, and are drained once the AO is done with
+                // its current event, see CompleteStep(), or upon the
+                // next receive, whichever is first.
+                me->mRxDoorbellArmed.store(true);
+            }
+        }
     }
     else
     {
         Q_ASSERT(userData != nullptr);
+        Q_ASSERT(bytes != nullptr);
+    }
+}
+
+void Service::ReceiveIntoRing(const uint8_t* bytes, size_t length)
+{
+    size_t dropped;
+    if (mOverloadPolicy == OverloadPolicy::DROP_OLDEST)
+    {
+        dropped = mRxRing.PushOverwrite(bytes, length);
+    }
+    else
+    {
+        uint16_t position = mRxRing.ProducerPosition();
+        dropped = length - mRxRing.Push(bytes, length);
+
+        // remember where input was first lost since the AO last
+        // caught up, so the AO knows which line is corrupt.
+        if ((dropped > 0) && (mRxDroppedBytes.load() == mRxDroppedBytesHandled.load()))
+        {
+            mRxLossPosition.store(static_cast<uint16_t>(position + (length - dropped)));
+        }
+    }
+
+    if (dropped > 0)
+    {
+        mRxDroppedBytes.store(mRxDroppedBytes.load() + static_cast<uint32_t>(dropped));
+    }
+
+    // the remote sender is paused as soon as the ring fills up,
+    // rather than once the AO gets around to draining it, which is
+    // when the ring is at risk of overflowing. Only a device's own
+    // flow control is applied from here. Software flow control,
+    // and resuming, is left to the AO, see UpdateReceiveFlowControl().
+    auto device = mCharacterDevice;
+    if (!mRxFlowStopped.load() && (mRxRing.Count() >= CMS_EMBEDDED_CLI_RX_HIGH_WATERMARK) && (device != nullptr) &&
+        device->SetReceiveFlowControl(cms::interfaces::CharacterDevice::FlowControl::STOP))
+    {
+        mRxFlowStopped.store(true);
+    }
+}
+
+void Service::DrainReceivedBytes()
+{
+    // re-arm before draining, so that any bytes arriving
+    // after the final Pop() below will ring the doorbell again.
+    mRxDoorbellArmed.store(true);
+
+    // bytes are handed to the embedded-cli a line at a time where
+    // possible, so that its paste fast path sees complete lines.
+    const size_t rxCapacity = mEmbeddedCliConfig->rxBufferSize - 1u;
+    size_t pending = 0;
+
+    std::array<uint8_t, RX_DRAIN_CHUNK_SIZE> chunk;
+    for (;;)
+    {
+        UpdateReceiveFlowControl();
+
+        // input is held back while the device is not keeping up
+        // with output, rather than dropping the echo and output
+        // it would cause. TX_READY_SIG or TX_RETRY_SIG resumes
+        // draining.
+        if (PendingOutput() > TX_INPUT_HOLD_LEVEL)
+        {
+            FlushOutput();
+            if (PendingOutput() > TX_INPUT_HOLD_LEVEL)
+            {
+                break;
+            }
+        }
+
+        // nor is it echoed within a long line of command output,
+        // which is only partly written.
+        if (mCommandLineOpen && (mBulkRing.Count() > 0) && !embeddedCliIsCommandRunning(mEmbeddedCli))
+        {
+            ReleaseBulkOutput();
+            if (mCommandLineOpen && (mBulkRing.Count() > 0))
+            {
+                break;
+            }
+        }
+
+        // a key pressed at the pager's prompt for the last page,
+        // shown once the command is done.
+        if (mPagerWaiting && !embeddedCliIsOutputPending(mEmbeddedCli))
+        {
+            if (HandlePagerKey())
+            {
+                ReleaseBulkOutput();
+                continue;
+            }
+            break;
+        }
+
+        // input waits while a command's output is being produced,
+        // other than a key pressed at the pager's prompt.
+        if (embeddedCliIsOutputPending(mEmbeddedCli))
+        {
+            ProduceOutput();
+            if (embeddedCliIsOutputPending(mEmbeddedCli))
+            {
+                if (mPagerWaiting && HandlePagerKey())
+                {
+                    continue;
+                }
+                break;
+            }
+        }
+
+        size_t maxLength = rxCapacity - pending;
+        maxLength = (chunk.size() < maxLength) ? chunk.size() : maxLength;
+        if ((mOverloadPolicy == OverloadPolicy::MARK_LINE_CORRUPT) &&
+            (mRxDroppedBytes.load() != mRxDroppedBytesHandled.load()))
+        {
+            // process everything received before the loss as usual
+            size_t intact = mRxRing.CountUntil(mRxLossPosition.load());
+            if (intact == 0)
+            {
+                if (pending > 0)
+                {
+                    embeddedCliProcess(mEmbeddedCli);
+                    pending = 0;
+                }
+                mRxDroppedBytesHandled.store(mRxDroppedBytes.load());
+                embeddedCliDiscardCommand(mEmbeddedCli);
+                mRxDiscardingLine = true;
+                continue;
+            }
+
+            maxLength = (intact < maxLength) ? intact : maxLength;
+        }
+
+        size_t length = mRxRing.Pop(chunk.data(), maxLength);
+        if (length == 0)
+        {
+            break;
+        }
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            char c = static_cast<char>(chunk[i]);
+            bool lineEnd = (c == '\r') || (c == '\n');
+            if (mRxDiscardingLine)
+            {
+                // the rest of a corrupt line is dropped, up to and
+                // including its end, which is passed along so the
+                // user is given a fresh prompt.
+                if (!lineEnd)
+                {
+                    continue;
+                }
+                mRxDiscardingLine = false;
+            }
+            embeddedCliReceiveChar(mEmbeddedCli, c);
+            ++pending;
+
+            if (lineEnd || (pending == rxCapacity))
+            {
+                embeddedCliProcess(mEmbeddedCli);
+                pending = 0;
+            }
+        }
+    }
+
+    if (pending > 0)
+    {
+        embeddedCliProcess(mEmbeddedCli);
+    }
+
+    ScheduleOutput();
+}
+
+void Service::UpdateReceiveFlowControl()
+{
+    using FlowControl = cms::interfaces::CharacterDevice::FlowControl;
+
+    // a nearly full AO queue means more work is waiting behind this
+    // drain, so input will not be processed promptly either. The
+    // high watermark is usually acted upon as bytes are received,
+    // but is checked here as well for software flow control.
+    size_t level = mRxRing.Count();
+    bool congested = (m_eQueue.getNFree() <= RX_DOORBELL_QUEUE_MARGIN);
+
+    // an XOFF/XON still waiting to be written counts as sent
+    bool stopped = mRxFlowPending ? mRxFlowPendingStop : mRxFlowStopped.load();
+
+    if (!stopped && (congested || (level >= CMS_EMBEDDED_CLI_RX_HIGH_WATERMARK)))
+    {
+        SetReceiveFlowControl(FlowControl::STOP);
+    }
+    else if (stopped && !congested && (level <= CMS_EMBEDDED_CLI_RX_LOW_WATERMARK))
+    {
+        SetReceiveFlowControl(FlowControl::GO);
+    }
+}
+
+void Service::SetReceiveFlowControl(cms::interfaces::CharacterDevice::FlowControl state)
+{
+    using FlowControl = cms::interfaces::CharacterDevice::FlowControl;
+
+    bool stop = (state == FlowControl::STOP);
+    if (mCharacterDevice->SetReceiveFlowControl(state) || mCharacterDevice->WriteAsync(stop ? XOFF : XON))
+    {
+        mRxFlowStopped = stop;
+        mRxFlowPending = false;
+    }
+    else
+    {
+        // the device refused the XOFF/XON. It is written ahead
+        // of any other output once the device has room again,
+        // see FlushOutput(), unless no longer needed by then.
+        mRxFlowPending = (stop != mRxFlowStopped.load());
+        mRxFlowPendingStop = stop;
     }
 }
 
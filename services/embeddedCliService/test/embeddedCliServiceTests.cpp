@@ -14,8 +14,19 @@
 
 #include "embeddedCliService.hpp"
 #include "embeddedCliEvent.hpp"
+#include "embeddedCliCommandTable.hpp"
+#include "embeddedCliArgs.hpp"
+#include "embeddedCliFormat.hpp"
+#include "embeddedCliNumberFormat.hpp"
+#include "embedded_cli.h"
 #include <array>
+#include <algorithm>
+#include <chrono>
+#include <utility>
 #include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstring>
 #include "cms_cpputest_qf_ctrl.hpp"
 #include "cmsTestPublishedEventRecorder.hpp"
 #include "pubsub_signals.hpp"
@@ -33,6 +44,19 @@ static std::array<QP::QEvt const*, 10> testQueueStorage;
 
 using Bytes = std::vector<uint8_t>;
 
+static void onQuietCmd(EmbeddedCli* cli, char* args, void* context)
+{
+    (void)cli;
+    (void)args;
+    (void)context;
+}
+
+//a short editing session, one keystroke per entry
+static const char* const EditingKeystrokes[] = {
+    "t", "e", "m", "\t", "1", "\x1B[D", "\x1B[D", "\x1B[C", "\x7F", "2", "\n",
+    "t", "e", "s", "t", " ", "3", "\x7F", "4", "\n", "\x1B[A", "\x1B[A", "\x1B[B"
+};
+
 TEST_GROUP(EmbeddedCliServiceTests)
 {
     EmbeddedCLI::Service* mUnderTest = nullptr;
@@ -61,10 +85,11 @@ TEST_GROUP(EmbeddedCliServiceTests)
         delete mMockCharacterDevice;
     }
 
-    void startService(uint64_t* buffer = nullptr, size_t bufferElementCount = 0, const char * customInvitation = nullptr, uint16_t maxCliCount = 16)
+    void startService(uint64_t* buffer = nullptr, size_t bufferElementCount = 0, const char * customInvitation = nullptr, uint16_t maxCliCount = 16,
+                      EmbeddedCLI::Service::RenderProfile profile = EmbeddedCLI::Service::RenderProfile::STANDARD)
     {
         using namespace cms::test;
-        mUnderTest = new EmbeddedCLI::Service(buffer, bufferElementCount, maxCliCount, customInvitation);
+        mUnderTest = new EmbeddedCLI::Service(buffer, bufferElementCount, maxCliCount, customInvitation, profile);
 
         mUnderTest->start(qf_ctrl::UNIT_UNDER_TEST_PRIORITY,
                           testQueueStorage.data(), testQueueStorage.size(),
@@ -74,11 +99,14 @@ TEST_GROUP(EmbeddedCliServiceTests)
         CHECK_TRUE(mRecorder->isSignalRecorded(CMS_EMBEDDED_CLI_INACTIVE_SIG));
     }
 
-    void startServiceToActive(const char * customInvitation = nullptr)
+    void startServiceToActive(const char * customInvitation = nullptr,
+                              EmbeddedCLI::Service::OverloadPolicy policy = EmbeddedCLI::Service::OverloadPolicy::MARK_LINE_CORRUPT,
+                              EmbeddedCLI::Service::RenderProfile profile = EmbeddedCLI::Service::RenderProfile::STANDARD)
     {
         using namespace cms::test;
 
-        startService(nullptr, 0, customInvitation);
+        startService(nullptr, 0, customInvitation, 16, profile);
+        mUnderTest->SetOverloadPolicy(policy);
         mock().ignoreOtherCalls();
         mUnderTest->BeginCliAsync(mMockCharacterDevice);
         qf_ctrl::ProcessEvents();
@@ -86,6 +114,49 @@ TEST_GROUP(EmbeddedCliServiceTests)
         CHECK_TRUE(mRecorder->isSignalRecorded(CMS_EMBEDDED_CLI_ACTIVE_SIG));
     }
 
+    std::string writtenToCharacterDevice() const
+    {
+        const std::vector<uint8_t>& written = mMockCharacterDevice->GetWrittenBytes();
+        return std::string(written.begin(), written.end());
+    }
+
+    //types EditingKeystrokes one event at a time, returns all output
+    std::string typeEditingKeystrokes()
+    {
+        using namespace cms::test;
+        mUnderTest->AddCliBindingAsync({"temp", "", false, nullptr, onQuietCmd});
+        mUnderTest->AddCliBindingAsync({"test", "", false, nullptr, onQuietCmd});
+        qf_ctrl::ProcessEvents();
+        mock("CharacterDevice").ignoreOtherCalls();
+        mMockCharacterDevice->ClearWrittenBytes();
+
+        for (const char* keystroke : EditingKeystrokes)
+        {
+            mMockCharacterDevice->InjectCharacterSequence(keystroke);
+            qf_ctrl::ProcessEvents();
+        }
+        return writtenToCharacterDevice();
+    }
+
+    static void reportBytesPerKeystroke(const char* profile, const std::string& output)
+    {
+        const size_t keystrokes = sizeof(EditingKeystrokes) / sizeof(EditingKeystrokes[0]);
+        char report[80];
+        snprintf(report, sizeof(report), "%s profile: %zu bytes for %zu keystrokes, %.2f per keystroke",
+                 profile, output.size(), keystrokes, double(output.size()) / double(keystrokes));
+        UT_PRINT(report);
+    }
+
+    static size_t countOccurrences(const std::string& output, const std::string& sequence)
+    {
+        size_t count = 0;
+        for (size_t pos = output.find(sequence); pos != std::string::npos; pos = output.find(sequence, pos + 1))
+        {
+            ++count;
+        }
+        return count;
+    }
+
     static void mockExpectWritesToCharacterDevice(const Bytes& expectedWrites)
     {
         for (uint8_t byte : expectedWrites)
@@ -191,7 +262,7 @@ TEST(EmbeddedCliServiceTests, upon_receiving_an_empty_linefeed_will_echo_same_an
     using namespace cms::test;
     startServiceToActive();
 
-    Bytes expectedWrites = {'\r', '\n', '>', ' ', 0x1b, '[', 's', 0x1b, '[', 'u'};
+    Bytes expectedWrites = {'\r', '\n', '>', ' '};
     mockExpectWritesToCharacterDevice(expectedWrites);
     mock().ignoreOtherCalls();
 
@@ -211,7 +282,7 @@ TEST(EmbeddedCliServiceTests, service_supports_static_memory_for_the_cli)
     // actual test only exercises the exact API which was inspected
     // for correctness.
     using namespace cms::test;
-    std::array<uint64_t, 100> staticMemory = {0};
+    std::array<uint64_t, 128> staticMemory = {0};
 
     startService(staticMemory.data(), staticMemory.size(), nullptr, 8);
     mock().ignoreOtherCalls();
@@ -226,7 +297,7 @@ TEST(EmbeddedCliServiceTests, service_supports_a_custom_invitation)
     using namespace cms::test;
     startServiceToActive("test> ");
 
-    Bytes expectedWrites = {'\r', '\n', 't', 'e', 's', 't', '>', ' ', 0x1b, '[', 's', 0x1b, '[', 'u'};
+    Bytes expectedWrites = {'\r', '\n', 't', 'e', 's', 't', '>', ' '};
     mockExpectWritesToCharacterDevice(expectedWrites);
     mock().ignoreOtherCalls();
 
@@ -384,3 +455,1913 @@ TEST(EmbeddedCliServiceTests, the_published_cli_active_event_includes_a_pointer_
     CHECK_EQUAL(CMS_EMBEDDED_CLI_ACTIVE_SIG, event->sig);
     CHECK_EQUAL(mUnderTest, event->mCliService);
 }
+
+TEST(EmbeddedCliServiceTests, a_burst_of_received_bytes_longer_than_the_ao_queue_is_processed)
+{
+    using namespace cms::test;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync({
+      "test",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTestCmd
+    });
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+
+    //this burst is much longer than the AO's event queue, which
+    //would assert if each byte required its own event.
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onTestCmd").withParameter("context", mUnderTest).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence("test 1 2 3 4 5 6 7 8 9 10 11 12 13\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+}
+
+TEST(EmbeddedCliServiceTests, character_devices_with_only_a_per_byte_callback_are_supported)
+{
+    using namespace cms::test;
+    delete mMockCharacterDevice;
+    mMockCharacterDevice = new cms::mocks::MockCharacterDevice(false);
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync({
+      "test",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTestCmd
+    });
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onTestCmd").withParameter("context", mUnderTest).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence("test\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+}
+
+TEST(EmbeddedCliServiceTests, many_bursts_received_before_the_ao_runs_share_one_doorbell_event)
+{
+    using namespace cms::test;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync({
+      "test",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTestCmd
+    });
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+
+    //more bursts than the AO's event queue can hold, all received
+    //before the AO has a chance to run.
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectNCalls(4, "onTestCmd").withParameter("context", mUnderTest).ignoreOtherParameters();
+    for (int i = 0; i < 4; ++i)
+    {
+        mMockCharacterDevice->InjectCharacterSequence("t");
+        mMockCharacterDevice->InjectCharacterSequence("e");
+        mMockCharacterDevice->InjectCharacterSequence("s");
+        mMockCharacterDevice->InjectCharacterSequence("t");
+        mMockCharacterDevice->InjectCharacterSequence("\n");
+    }
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+}
+
+TEST(EmbeddedCliServiceTests, by_default_a_line_with_lost_input_is_not_executed)
+{
+    using namespace cms::test;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync({
+      "test",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTestCmd
+    });
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+
+    //fill the receive ring exactly, such that the
+    //line's terminating newline is lost.
+    std::string line = "test";
+    line.append(CMS_EMBEDDED_CLI_RX_RING_SIZE - line.size(), ' ');
+    line.append("\n");
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectNoCall("onTestCmd");
+    mMockCharacterDevice->InjectCharacterSequence(line.c_str());
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->InjectCharacterSequence("\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+    CHECK_EQUAL(1, mUnderTest->GetDroppedByteCount());
+    mock().clear();
+
+    //and the following line is intact
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onTestCmd").withParameter("context", mUnderTest).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence("test\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+}
+
+TEST(EmbeddedCliServiceTests, drop_newest_overload_policy_discards_only_the_bytes_that_do_not_fit)
+{
+    using namespace cms::test;
+    startServiceToActive(nullptr, EmbeddedCLI::Service::OverloadPolicy::DROP_NEWEST);
+
+    mUnderTest->AddCliBindingAsync({
+      "test",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTestCmd
+    });
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+
+    std::string line = "test";
+    line.append(CMS_EMBEDDED_CLI_RX_RING_SIZE - line.size(), ' ');
+    line.append("\n");
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onTestCmd").withParameter("context", mUnderTest).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence(line.c_str());
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->InjectCharacterSequence("\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+    CHECK_EQUAL(1, mUnderTest->GetDroppedByteCount());
+}
+
+TEST(EmbeddedCliServiceTests, drop_oldest_overload_policy_keeps_the_most_recent_input)
+{
+    using namespace cms::test;
+    startServiceToActive(nullptr, EmbeddedCLI::Service::OverloadPolicy::DROP_OLDEST);
+
+    mUnderTest->AddCliBindingAsync({
+      "test",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTestCmd
+    });
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+
+    static constexpr size_t OVERFLOW = 50;
+    std::string garbage(CMS_EMBEDDED_CLI_RX_RING_SIZE + OVERFLOW, 'x');
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onTestCmd").withParameter("context", mUnderTest).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence(garbage.c_str());
+    mMockCharacterDevice->InjectCharacterSequence("\ntest\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+    CHECK_EQUAL(OVERFLOW + 6, mUnderTest->GetDroppedByteCount());
+}
+
+TEST(EmbeddedCliServiceTests, received_input_is_not_lost_when_the_ao_queue_is_congested)
+{
+    using namespace cms::test;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync({
+      "test",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTestCmd
+    });
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+
+    //fill the AO's queue, leaving no room above the doorbell's margin
+    for (size_t i = 0; i < testQueueStorage.size(); ++i)
+    {
+        mUnderTest->AddCliBindingAsync({
+          "temp",
+          "Help Me!",
+          true,
+          mUnderTest,
+          onTempCmd
+        });
+    }
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onTestCmd").withParameter("context", mUnderTest).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence("tes");
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->InjectCharacterSequence("t\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+    CHECK_EQUAL(0, mUnderTest->GetDroppedByteCount());
+}
+
+TEST(EmbeddedCliServiceTests, the_last_received_input_is_processed_when_the_ao_queue_is_congested)
+{
+    using namespace cms::test;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync({
+      "test",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTestCmd
+    });
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+
+    //fill the AO's queue, leaving no room above the doorbell's margin
+    for (size_t i = 0; i < testQueueStorage.size(); ++i)
+    {
+        mUnderTest->AddCliBindingAsync({
+          "temp",
+          "Help Me!",
+          true,
+          mUnderTest,
+          onTempCmd
+        });
+    }
+
+    //and nothing more is received after this
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onTestCmd").withParameter("context", mUnderTest).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence("test\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+    CHECK_EQUAL(0, mUnderTest->GetDroppedByteCount());
+}
+
+TEST(EmbeddedCliServiceTests, a_burst_above_the_high_watermark_sends_xoff_then_xon)
+{
+    using namespace cms::test;
+    static constexpr uint8_t XON = 0x11;
+    static constexpr uint8_t XOFF = 0x13;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync({
+      "test",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTestCmd
+    });
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    std::string line = "test";
+    line.append(CMS_EMBEDDED_CLI_RX_HIGH_WATERMARK - line.size(), ' ');
+    line.append("\n");
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onTestCmd").withParameter("context", mUnderTest).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence(line.c_str());
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    const std::vector<uint8_t>& written = mMockCharacterDevice->GetWrittenBytes();
+    CHECK_FALSE(written.empty());
+    CHECK_EQUAL(XOFF, written.front());
+    CHECK_EQUAL(1, std::count(written.begin(), written.end(), XOFF));
+    CHECK_EQUAL(1, std::count(written.begin(), written.end(), XON));
+}
+
+TEST(EmbeddedCliServiceTests, xoff_refused_by_the_device_is_written_ahead_of_other_output)
+{
+    using namespace cms::test;
+    static constexpr uint8_t XON = 0x11;
+    static constexpr uint8_t XOFF = 0x13;
+    startServiceToActive();
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    //enough output, refused by the device, that further input is held back
+    mMockCharacterDevice->SetWriteSpace(0);
+    std::string lines((CMS_EMBEDDED_CLI_TX_RING_SIZE / 8) + 1, '\n');
+    mMockCharacterDevice->InjectCharacterSequence(lines.c_str());
+    qf_ctrl::ProcessEvents();
+
+    std::string line(CMS_EMBEDDED_CLI_RX_HIGH_WATERMARK, ' ');
+    line.append("\n");
+    mMockCharacterDevice->InjectCharacterSequence(line.c_str());
+    qf_ctrl::ProcessEvents();
+    CHECK_TRUE(mMockCharacterDevice->GetWrittenBytes().empty());
+
+    mMockCharacterDevice->SignalWriteReady();
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    const std::vector<uint8_t>& written = mMockCharacterDevice->GetWrittenBytes();
+    CHECK_FALSE(written.empty());
+    CHECK_EQUAL(XOFF, written.front());
+    CHECK_EQUAL(1, std::count(written.begin(), written.end(), XOFF));
+    CHECK_EQUAL(1, std::count(written.begin(), written.end(), XON));
+}
+
+TEST(EmbeddedCliServiceTests, a_burst_below_the_high_watermark_does_not_apply_flow_control)
+{
+    using namespace cms::test;
+    delete mMockCharacterDevice;
+    mMockCharacterDevice = new cms::mocks::MockCharacterDevice(true, true);
+    startServiceToActive();
+
+    //including the newline, one byte below the high watermark
+    std::string line(CMS_EMBEDDED_CLI_RX_HIGH_WATERMARK - 2, ' ');
+    line.append("\n");
+
+    mock("CharacterDevice").expectNoCall("SetReceiveFlowControl");
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->InjectCharacterSequence(line.c_str());
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+}
+
+TEST(EmbeddedCliServiceTests, character_device_flow_control_is_used_when_supported)
+{
+    using namespace cms::test;
+    static constexpr uint8_t XON = 0x11;
+    static constexpr uint8_t XOFF = 0x13;
+    delete mMockCharacterDevice;
+    mMockCharacterDevice = new cms::mocks::MockCharacterDevice(true, true);
+    startServiceToActive();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    std::string line(CMS_EMBEDDED_CLI_RX_HIGH_WATERMARK, ' ');
+    line.append("\n");
+
+    mock("CharacterDevice").expectOneCall("SetReceiveFlowControl").withParameter("stop", true);
+    mock("CharacterDevice").expectOneCall("SetReceiveFlowControl").withParameter("stop", false);
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->InjectCharacterSequence(line.c_str());
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    for (uint8_t byte : mMockCharacterDevice->GetWrittenBytes())
+    {
+        CHECK_TRUE((byte != XON) && (byte != XOFF));
+    }
+}
+
+TEST(EmbeddedCliServiceTests, flow_control_stops_the_sender_as_input_is_received_rather_than_once_the_ao_runs)
+{
+    using namespace cms::test;
+    delete mMockCharacterDevice;
+    mMockCharacterDevice = new cms::mocks::MockCharacterDevice(true, true);
+    startServiceToActive();
+
+    std::string line(CMS_EMBEDDED_CLI_RX_HIGH_WATERMARK, ' ');
+    line.append("\n");
+
+    mock("CharacterDevice").expectOneCall("SetReceiveFlowControl").withParameter("stop", true);
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->InjectCharacterSequence(line.c_str());
+    mock().checkExpectations();
+
+    mock("CharacterDevice").expectOneCall("SetReceiveFlowControl").withParameter("stop", false);
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+}
+
+TEST(EmbeddedCliServiceTests, a_pasted_line_is_echoed_once_without_per_character_redraws)
+{
+    using namespace cms::test;
+    static const std::string cursorSave = "\x1B[s";
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync({
+      "test",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTestCmd
+    });
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onTestCmd").withParameter("context", mUnderTest).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence("test 1 2 3\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    std::string output = writtenToCharacterDevice();
+    CHECK_EQUAL(0, output.find("test 1 2 3"));
+
+    //the line has no live autocompletion, so there is nothing to redraw
+    CHECK_EQUAL(0, countOccurrences(output, cursorSave));
+}
+
+TEST(EmbeddedCliServiceTests, live_autocompletion_is_drawn_once_per_burst_of_typed_characters)
+{
+    using namespace cms::test;
+    static const std::string cursorSave = "\x1B[s";
+    static const char* const burst = "tes";
+    startServiceToActive();
+    mUnderTest->AddCliBindingAsync({"temp", "", false, nullptr, onTestCmd});
+    mUnderTest->AddCliBindingAsync({"test", "", false, nullptr, onTestCmd});
+    qf_ctrl::ProcessEvents();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    //typed one keystroke at a time, live autocompletion is redrawn
+    //after 't' ("te") and 's' ("test"), 'e' matches what is shown
+    mMockCharacterDevice->ClearWrittenBytes();
+    for (const char* c = burst; *c != '\0'; ++c)
+    {
+        const char keystroke[] = {*c, '\0'};
+        mMockCharacterDevice->InjectCharacterSequence(keystroke);
+        qf_ctrl::ProcessEvents();
+    }
+    std::string typed = writtenToCharacterDevice();
+    CHECK_EQUAL(2, countOccurrences(typed, cursorSave));
+
+    //start over on a fresh line
+    mMockCharacterDevice->InjectCharacterSequence("\n");
+    qf_ctrl::ProcessEvents();
+
+    //received as one burst, there is a single redraw
+    mMockCharacterDevice->ClearWrittenBytes();
+    mMockCharacterDevice->InjectCharacterSequence(burst);
+    qf_ctrl::ProcessEvents();
+    std::string received = writtenToCharacterDevice();
+    CHECK_EQUAL(1, countOccurrences(received, cursorSave));
+    CHECK_TRUE(received.size() < typed.size());
+}
+
+TEST(EmbeddedCliServiceTests, a_command_edited_in_the_middle_is_executed_as_edited)
+{
+    using namespace cms::test;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync({
+      "test",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTestCmd
+    });
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+
+    //"txst", two cursor lefts, backspace the 'x', insert 'e'
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onTestCmd").withParameter("context", mUnderTest).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence("txst\x1B[D\x1B[D\be\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+}
+
+TEST(EmbeddedCliServiceTests, tab_completion_is_correct_after_a_mistyped_character_is_deleted)
+{
+    using namespace cms::test;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync({
+      "test",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTestCmd
+    });
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+
+    //"tx" has no candidates, "te" must be completed to "test"
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onTestCmd").withParameter("context", mUnderTest).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence("tx\be\t\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+}
+
+TEST(EmbeddedCliServiceTests, help_lists_commands_in_alphabetical_order)
+{
+    using namespace cms::test;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync({
+      "test",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTestCmd
+    });
+    mUnderTest->AddCliBindingAsync({
+      "temp",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTempCmd
+    });
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->InjectCharacterSequence("help\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    std::string output = writtenToCharacterDevice();
+    size_t help = output.find(" * help");
+    size_t temp = output.find(" * temp");
+    size_t test = output.find(" * test");
+    CHECK_TRUE(help != std::string::npos);
+    CHECK_TRUE(help < temp);
+    CHECK_TRUE(temp < test);
+    CHECK_TRUE(test != std::string::npos);
+}
+
+static int testTableContext;
+
+static constexpr cms::EmbeddedCLI::CommandBinding TestTableBindings[] = {
+    {"testing", "Help Me!", true, &testTableContext, onTestCmd},
+    {"temp", "Temp Me!", true, &testTableContext, onTempCmd},
+};
+
+TEST(EmbeddedCliServiceTests, commands_from_a_static_table_can_be_executed_and_completed)
+{
+    using namespace cms::test;
+    using cms::EmbeddedCLI::StaticCommandTable;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingTableAsync(StaticCommandTable<TestTableBindings>::Get());
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onTempCmd").withParameter("context", &testTableContext).ignoreOtherParameters();
+    mock("TEST").expectOneCall("onTestCmd").withParameter("context", &testTableContext).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence("temp\n");
+    mMockCharacterDevice->InjectCharacterSequence("tes\t\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+}
+
+//not sorted by name, as a hand written table often is not
+static const cms::EmbeddedCLI::CommandBinding UnsortedBindings[] = {
+    {"zulu", "Zulu Me!", true, &testTableContext, onTestCmd},
+    {"temp", "Temp Me!", true, &testTableContext, onTempCmd},
+    {"alpha", "Alpha Me!", true, &testTableContext, onTestCmd},
+    {"testing", "Help Me!", true, &testTableContext, onTestCmd},
+};
+
+TEST(EmbeddedCliServiceTests, an_unsorted_const_array_of_bindings_is_added_in_place_with_one_event)
+{
+    using namespace cms::test;
+    //the array does not use any of the bindings counted here
+    startService(nullptr, 0, nullptr, 1);
+    mock().ignoreOtherCalls();
+    mUnderTest->BeginCliAsync(mMockCharacterDevice);
+    qf_ctrl::ProcessEvents();
+
+    mUnderTest->AddCliBindingsAsync(UnsortedBindings);
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onTempCmd").withParameter("context", &testTableContext).ignoreOtherParameters();
+    mock("TEST").expectOneCall("onTestCmd").withParameter("context", &testTableContext).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence("temp\n");
+    mMockCharacterDevice->InjectCharacterSequence("tes\t\n");
+    mMockCharacterDevice->InjectCharacterSequence("help\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    std::string output = writtenToCharacterDevice();
+    size_t alpha = output.find(" * alpha");
+    size_t help = output.find(" * help");
+    size_t temp = output.find(" * temp");
+    size_t testing = output.find(" * testing");
+    size_t zulu = output.find(" * zulu");
+    CHECK_TRUE(alpha < help);
+    CHECK_TRUE(help < temp);
+    CHECK_TRUE(temp < testing);
+    CHECK_TRUE(testing < zulu);
+    CHECK_TRUE(zulu != std::string::npos);
+}
+
+//commands of several modules, each registering its own flash array
+static const cms::EmbeddedCLI::CommandBinding ModuleBindings[][1] = {
+    {{"motor", "Motor Me!", true, &testTableContext, onTestCmd}},
+    {{"sensor", "Sensor Me!", true, &testTableContext, onTestCmd}},
+    {{"radio", "Radio Me!", true, &testTableContext, onTestCmd}},
+    {{"power", "Power Me!", true, &testTableContext, onTestCmd}},
+};
+static_assert(CMS_EMBEDDED_CLI_MAX_BINDING_TABLES > 2, "more tables than the embedded-cli default are supported");
+static_assert(CMS_EMBEDDED_CLI_MAX_BINDING_TABLES <= std::size(ModuleBindings), "test needs more modules");
+
+TEST(EmbeddedCliServiceTests, up_to_the_configured_number_of_binding_tables_may_be_added)
+{
+    using namespace cms::test;
+    using cms::EmbeddedCLI::StaticCommandTable;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingTableAsync(StaticCommandTable<TestTableBindings>::Get());
+    for (size_t i = 1; i < CMS_EMBEDDED_CLI_MAX_BINDING_TABLES; ++i)
+    {
+        mUnderTest->AddCliBindingsAsync(ModuleBindings[i - 1]);
+    }
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onTempCmd").withParameter("context", &testTableContext).ignoreOtherParameters();
+    mock("TEST").expectNCalls(CMS_EMBEDDED_CLI_MAX_BINDING_TABLES - 1, "onTestCmd")
+        .withParameter("context", &testTableContext).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence("temp\n");
+    for (size_t i = 1; i < CMS_EMBEDDED_CLI_MAX_BINDING_TABLES; ++i)
+    {
+        mMockCharacterDevice->InjectCharacterSequence((std::string(ModuleBindings[i - 1][0].name) + "\n").c_str());
+    }
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+}
+
+TEST(EmbeddedCliServiceTests, help_lists_commands_from_static_tables_in_alphabetical_order)
+{
+    using namespace cms::test;
+    using cms::EmbeddedCLI::StaticCommandTable;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync({
+      "status",
+      "Help Me!",
+      true,
+      mUnderTest,
+      onTestCmd
+    });
+    mUnderTest->AddCliBindingTableAsync(StaticCommandTable<TestTableBindings>::Get());
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->InjectCharacterSequence("help\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    std::string output = writtenToCharacterDevice();
+    size_t help = output.find(" * help");
+    size_t status = output.find(" * status");
+    size_t temp = output.find(" * temp");
+    size_t testing = output.find(" * testing");
+    CHECK_TRUE(help != std::string::npos);
+    CHECK_TRUE(help < status);
+    CHECK_TRUE(status < temp);
+    CHECK_TRUE(temp < testing);
+    CHECK_TRUE(testing != std::string::npos);
+}
+
+static void onShowCmd(EmbeddedCli* cli, char* args, void* context)
+{
+    (void)cli;
+    (void)context;
+    mock("TEST").actualCall(__FUNCTION__).withParameter("arg", embeddedCliGetToken(args, 1));
+}
+
+static constexpr cms::EmbeddedCLI::CommandBinding NetIfBindings[] = {
+    {"show", "Show an interface", true, &testTableContext, onShowCmd},
+    {"set", "Configure an interface", true, &testTableContext, onTempCmd},
+};
+
+static constexpr cms::EmbeddedCLI::CommandBinding NetBindings[] = {
+    {"ping", "Ping a host", true, &testTableContext, onTempCmd},
+    {"if", "Interface commands", true, nullptr, nullptr,
+     &cms::EmbeddedCLI::StaticCommandTable<NetIfBindings>::Get()},
+};
+
+static const cms::EmbeddedCLI::CommandBinding NetGroup = {
+    "net", "Network commands", true, nullptr, nullptr,
+    &cms::EmbeddedCLI::StaticCommandTable<NetBindings>::Get()
+};
+
+TEST(EmbeddedCliServiceTests, nested_subcommands_are_dispatched_with_the_remaining_args)
+{
+    using namespace cms::test;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync(NetGroup);
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onShowCmd").withParameter("arg", "eth0");
+    mock("TEST").expectOneCall("onTempCmd").withParameter("context", &testTableContext).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence("net  if show   eth0\n");
+    mMockCharacterDevice->InjectCharacterSequence("net ping\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+}
+
+TEST(EmbeddedCliServiceTests, subcommands_are_tab_completed_at_each_level)
+{
+    using namespace cms::test;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync(NetGroup);
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mock("TEST").expectOneCall("onShowCmd").withParameter("arg", "eth1");
+    mock("TEST").expectOneCall("onTempCmd").withParameter("context", &testTableContext).ignoreOtherParameters();
+    mMockCharacterDevice->InjectCharacterSequence("ne\ti\tsh\teth1\n");
+    mMockCharacterDevice->InjectCharacterSequence("net p\t\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    //ambiguous subcommands are listed, as commands are
+    mMockCharacterDevice->ClearWrittenBytes();
+    mMockCharacterDevice->InjectCharacterSequence("net if s\t");
+    qf_ctrl::ProcessEvents();
+    std::string output = writtenToCharacterDevice();
+    size_t set = output.find("set\r\n");
+    size_t show = output.find("show\r\n");
+    CHECK_TRUE(set < show);
+    CHECK_TRUE(show != std::string::npos);
+}
+
+TEST(EmbeddedCliServiceTests, help_describes_groups_and_their_subcommands)
+{
+    using namespace cms::test;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync(NetGroup);
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->InjectCharacterSequence("help net\n");
+    qf_ctrl::ProcessEvents();
+    std::string output = writtenToCharacterDevice();
+    CHECK_TRUE(output.find(" * net\r\n\tNetwork commands\r\n\t * if\r\n\t * ping\r\n") != std::string::npos);
+
+    mMockCharacterDevice->ClearWrittenBytes();
+    mMockCharacterDevice->InjectCharacterSequence("help net if show\n");
+    qf_ctrl::ProcessEvents();
+    output = writtenToCharacterDevice();
+    CHECK_TRUE(output.find(" * show\r\n\tShow an interface\r\n") != std::string::npos);
+
+    //a group without a binding function lists its subcommands
+    mMockCharacterDevice->ClearWrittenBytes();
+    mMockCharacterDevice->InjectCharacterSequence("net if\n");
+    qf_ctrl::ProcessEvents();
+    output = writtenToCharacterDevice();
+    CHECK_TRUE(output.find("\t * set\r\n\t * show\r\n") != std::string::npos);
+
+    mMockCharacterDevice->ClearWrittenBytes();
+    mMockCharacterDevice->InjectCharacterSequence("net bogus\n");
+    qf_ctrl::ProcessEvents();
+    output = writtenToCharacterDevice();
+    CHECK_TRUE(output.find("Unknown subcommand: \"bogus\"") != std::string::npos);
+    CHECK_TRUE(output.find("\t * ping\r\n") != std::string::npos);
+}
+
+struct WriteArgs {
+    uint32_t address;
+    uint8_t value;
+    int16_t offset = 0;
+    uint8_t count = 1;
+    bool verify;
+};
+
+static constexpr cms::EmbeddedCLI::ArgSpec WriteSchema[] = {
+    cms::EmbeddedCLI::Positional<&WriteArgs::address>("address"),
+    cms::EmbeddedCLI::Positional<&WriteArgs::value>("value"),
+    cms::EmbeddedCLI::OptionalPositional<&WriteArgs::offset>("offset", -100, 100),
+    cms::EmbeddedCLI::Option<&WriteArgs::count>("--count", 1, 16),
+    cms::EmbeddedCLI::Flag<&WriteArgs::verify>("--verify"),
+};
+
+static WriteArgs lastWriteArgs;
+static int writeCmdCalls;
+
+static void onWriteCmd(EmbeddedCli* cli, const WriteArgs& args, void* context)
+{
+    (void)cli;
+    (void)context;
+    lastWriteArgs = args;
+    ++writeCmdCalls;
+}
+
+TEST(EmbeddedCliServiceTests, typed_arguments_are_parsed_into_a_struct_before_the_handler_is_called)
+{
+    using namespace cms::test;
+    using cms::EmbeddedCLI::ParsedCommand;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync(ParsedCommand<WriteSchema, onWriteCmd>("write", "write <address> <value>"));
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+    mock("CharacterDevice").ignoreOtherCalls();
+    writeCmdCalls = 0;
+
+    mMockCharacterDevice->InjectCharacterSequence("write 0x2000001F 255 --verify -100 --count 16\n");
+    qf_ctrl::ProcessEvents();
+    CHECK_EQUAL(1, writeCmdCalls);
+    CHECK_EQUAL(0x2000001Fu, lastWriteArgs.address);
+    CHECK_EQUAL(255, lastWriteArgs.value);
+    CHECK_EQUAL(-100, lastWriteArgs.offset);
+    CHECK_EQUAL(16, lastWriteArgs.count);
+    CHECK_TRUE(lastWriteArgs.verify);
+
+    //arguments which are not given keep the defaults of the struct
+    mMockCharacterDevice->InjectCharacterSequence("write 16 0\n");
+    qf_ctrl::ProcessEvents();
+    CHECK_EQUAL(2, writeCmdCalls);
+    CHECK_EQUAL(16u, lastWriteArgs.address);
+    CHECK_EQUAL(0, lastWriteArgs.value);
+    CHECK_EQUAL(0, lastWriteArgs.offset);
+    CHECK_EQUAL(1, lastWriteArgs.count);
+    CHECK_FALSE(lastWriteArgs.verify);
+}
+
+TEST(EmbeddedCliServiceTests, bad_typed_arguments_are_rejected_with_a_message_instead_of_calling_the_handler)
+{
+    using namespace cms::test;
+    using cms::EmbeddedCLI::ParsedCommand;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync(ParsedCommand<WriteSchema, onWriteCmd>("write", "write <address> <value>"));
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+    mock("CharacterDevice").ignoreOtherCalls();
+    writeCmdCalls = 0;
+
+    const std::pair<const char*, const char*> rejected[] = {
+        {"write 16 256\n", "Out of range value \"256\" for <value>, expected 0 to 255"},
+        {"write 16 1 -101\n", "Out of range value \"-101\" for <offset>, expected -100 to 100"},
+        {"write 16 1 --count 0\n", "Out of range value \"0\" for --count, expected 1 to 16"},
+        {"write 0x100000000 1\n", "Out of range value \"0x100000000\" for <address>, expected 0 to 4294967295"},
+        {"write -1 1\n", "Out of range value \"-1\" for <address>"},
+        {"write 16 1x\n", "Invalid number \"1x\" for <value>"},
+        {"write 16\n", "Missing argument <value>"},
+        {"write 16 1 --count\n", "Missing value for --count"},
+        {"write 16 1 2 3\n", "Unexpected argument \"3\""},
+        {"write 16 1 --force\n", "Unknown option \"--force\""},
+    };
+
+    for (const auto& entry : rejected)
+    {
+        mMockCharacterDevice->ClearWrittenBytes();
+        mMockCharacterDevice->InjectCharacterSequence(entry.first);
+        qf_ctrl::ProcessEvents();
+        std::string output = writtenToCharacterDevice();
+        CHECK_TEXT(output.find(entry.second) != std::string::npos, entry.first);
+    }
+    CHECK_EQUAL(0, writeCmdCalls);
+}
+
+static std::vector<std::string> lastArgv;
+
+static void onArgvCmd(EmbeddedCli*, uint16_t argc, const cms::EmbeddedCLI::CommandToken* argv, void*)
+{
+    lastArgv.clear();
+    for (uint16_t i = 0; i < argc; ++i)
+    {
+        CHECK_EQUAL(strlen(argv[i].str), argv[i].len);
+        lastArgv.emplace_back(argv[i].str, argv[i].len);
+    }
+}
+
+TEST(EmbeddedCliServiceTests, args_are_tokenized_into_an_index_in_a_single_pass)
+{
+    using cms::EmbeddedCLI::CommandToken;
+    using cms::EmbeddedCLI::TokenizeArgs;
+
+    //the args of a bulk write, 70 bytes
+    std::string args = "0x20000000";
+    for (int i = 1; i < 70; ++i)
+    {
+        args += "  " + std::to_string(i);
+    }
+    std::vector<char> buffer(args.begin(), args.end());
+    buffer.resize(buffer.size() + 2, '\0');
+
+    CommandToken argv[80];
+    CHECK_EQUAL(70, TokenizeArgs(buffer.data(), argv, 80));
+    STRCMP_EQUAL("0x20000000", argv[0].str);
+    CHECK_EQUAL(10, argv[0].len);
+    for (int i = 1; i < 70; ++i)
+    {
+        STRCMP_EQUAL(std::to_string(i).c_str(), argv[i].str);
+    }
+
+    //the args remain tokenized as embeddedCliGetToken expects
+    STRCMP_EQUAL("69", embeddedCliGetToken(buffer.data(), 70));
+
+    //only as many tokens as fit are indexed, while all are counted
+    char quoted[] = "one \"two three\" fo\\\"ur\0";
+    CommandToken few[2];
+    CHECK_EQUAL(3, TokenizeArgs(quoted, few, 2));
+    STRCMP_EQUAL("one", few[0].str);
+    STRCMP_EQUAL("two three", few[1].str);
+    CHECK_EQUAL(9, few[1].len);
+
+    CHECK_EQUAL(0, TokenizeArgs(nullptr, few, 2));
+}
+
+TEST(EmbeddedCliServiceTests, argv_commands_receive_their_args_as_an_index)
+{
+    using namespace cms::test;
+    using cms::EmbeddedCLI::ArgvCommand;
+    startServiceToActive();
+
+    mUnderTest->AddCliBindingAsync(ArgvCommand<onArgvCmd, 4>("poke", "poke <address> <bytes>..."));
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    mMockCharacterDevice->InjectCharacterSequence("poke 0x10 \"a b\" c\\\"d\n");
+    qf_ctrl::ProcessEvents();
+    CHECK_EQUAL(3, lastArgv.size());
+    STRCMP_EQUAL("0x10", lastArgv[0].c_str());
+    STRCMP_EQUAL("a b", lastArgv[1].c_str());
+    STRCMP_EQUAL("c\"d", lastArgv[2].c_str());
+
+    mMockCharacterDevice->InjectCharacterSequence("poke\n");
+    qf_ctrl::ProcessEvents();
+    CHECK_EQUAL(0, lastArgv.size());
+
+    //more args than the index holds are rejected, without calling the handler
+    lastArgv.assign(1, "untouched");
+    mMockCharacterDevice->ClearWrittenBytes();
+    mMockCharacterDevice->InjectCharacterSequence("poke 1 2 3 4 5\n");
+    qf_ctrl::ProcessEvents();
+    CHECK_EQUAL(1, lastArgv.size());
+    std::string output = writtenToCharacterDevice();
+    CHECK_TEXT(output.find("Too many arguments: 5, at most 4 are accepted") != std::string::npos, output.c_str());
+}
+
+class Motor {
+public:
+    void OnSpeed(EmbeddedCli*, char* args)
+    {
+        mSpeed = atoi(embeddedCliGetToken(args, 1));
+    }
+
+    void OnShow(EmbeddedCli* cli, char*) const
+    {
+        cms::EmbeddedCLI::PrintFormatted(cli, "speed %d", mSpeed);
+    }
+
+    void Stop()
+    {
+        mSpeed = 0;
+    }
+
+    int mSpeed = 0;
+};
+
+static constexpr auto onMotorStop = [](Motor& motor, EmbeddedCli*, char*) { motor.Stop(); };
+static constexpr auto onMotorShow = [](const Motor& motor, EmbeddedCli* cli, char* args) { motor.OnShow(cli, args); };
+
+//a binding to a temporary object would be left with a dangling context, so must not compile
+template <typename Object, typename = void>
+struct BindsMemberCommand : std::false_type {};
+template <typename Object>
+struct BindsMemberCommand<Object, std::void_t<decltype(EmbeddedCLI::MemberCommand<&Motor::OnShow>("", "", std::declval<Object>()))>>
+    : std::true_type {};
+
+template <typename Object, typename = void>
+struct BindsLambdaCommand : std::false_type {};
+template <typename Object>
+struct BindsLambdaCommand<Object, std::void_t<decltype(EmbeddedCLI::LambdaCommand<onMotorShow>("", "", std::declval<Object>()))>>
+    : std::true_type {};
+
+static_assert(BindsMemberCommand<const Motor&>::value, "const member functions bind to objects");
+static_assert(!BindsMemberCommand<Motor>::value, "temporaries must not compile");
+static_assert(!BindsMemberCommand<const Motor>::value, "const temporaries must not compile");
+static_assert(BindsLambdaCommand<const Motor&>::value, "lambdas bind to objects");
+static_assert(!BindsLambdaCommand<Motor>::value, "temporaries must not compile");
+static_assert(!BindsLambdaCommand<const Motor>::value, "const temporaries must not compile");
+
+TEST(EmbeddedCliServiceTests, member_functions_and_lambdas_are_bound_to_their_object)
+{
+    using namespace cms::test;
+    using cms::EmbeddedCLI::LambdaCommand;
+    using cms::EmbeddedCLI::MemberCommand;
+    startServiceToActive();
+
+    Motor motor;
+    const Motor& shown = motor;
+    mUnderTest->AddCliBindingAsync(MemberCommand<&Motor::OnSpeed>("speed", "speed <rpm>", motor, true));
+    mUnderTest->AddCliBindingAsync(MemberCommand<&Motor::OnShow>("show", "shows the speed", shown));
+    mUnderTest->AddCliBindingAsync(LambdaCommand<onMotorStop>("stop", "stops the motor", motor));
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    mMockCharacterDevice->InjectCharacterSequence("speed 1200\n");
+    qf_ctrl::ProcessEvents();
+    CHECK_EQUAL(1200, motor.mSpeed);
+
+    mMockCharacterDevice->ClearWrittenBytes();
+    mMockCharacterDevice->InjectCharacterSequence("show\n");
+    qf_ctrl::ProcessEvents();
+    std::string output = writtenToCharacterDevice();
+    CHECK_TEXT(output.find("speed 1200") != std::string::npos, output.c_str());
+
+    mMockCharacterDevice->InjectCharacterSequence("stop\n");
+    qf_ctrl::ProcessEvents();
+    CHECK_EQUAL(0, motor.mSpeed);
+}
+
+TEST(EmbeddedCliServiceTests, a_help_listing_is_written_to_the_device_in_a_few_blocks)
+{
+    using namespace cms::test;
+    startService();
+    //let the listing use the entire transmit ring
+    mUnderTest->SetBulkOutputShare(100);
+    mock().ignoreOtherCalls();
+    mUnderTest->BeginCliAsync(mMockCharacterDevice);
+    qf_ctrl::ProcessEvents();
+
+    static const char* names[] = {"alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel"};
+    for (const char* name : names)
+    {
+        mUnderTest->AddCliBindingAsync({
+          name,
+          "Help text which is long enough to make the listing span blocks",
+          true,
+          mUnderTest,
+          onTestCmd
+        });
+    }
+    qf_ctrl::ProcessEvents();
+    mock().clear();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->InjectCharacterSequence("help\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    std::string output = writtenToCharacterDevice();
+    CHECK_TRUE(output.find(" * hotel") != std::string::npos);
+    //one more block each time the output wraps around the transmit ring
+    size_t maxBlocks = 2 * ((output.size() / CMS_EMBEDDED_CLI_TX_RING_SIZE) + 1);
+    CHECK_TRUE(mMockCharacterDevice->GetBulkWriteCount() <= maxBlocks);
+}
+
+TEST(EmbeddedCliServiceTests, character_devices_which_only_write_a_byte_at_a_time_are_supported)
+{
+    using namespace cms::test;
+    delete mMockCharacterDevice;
+    mMockCharacterDevice = new cms::mocks::MockCharacterDevice(true, false, false);
+    startService();
+
+    Bytes expectedWrites = { '>', ' ' };
+    mockExpectWritesToCharacterDevice(expectedWrites);
+    mock().ignoreOtherCalls();
+
+    mRecorder->oneShotIgnoreEvent(CMS_EMBEDDED_CLI_ACTIVE_SIG);
+    mUnderTest->BeginCliAsync(mMockCharacterDevice);
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+    CHECK_EQUAL(0U, mMockCharacterDevice->GetBulkWriteCount());
+}
+
+TEST(EmbeddedCliServiceTests, output_refused_by_the_device_is_written_once_the_device_is_ready)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    mMockCharacterDevice->SetWriteSpace(3);
+    mMockCharacterDevice->InjectCharacterSequence("\n");
+    qf_ctrl::ProcessEvents();
+    STRCMP_EQUAL("\r\n>", writtenToCharacterDevice().c_str());
+
+    mMockCharacterDevice->SignalWriteReady();
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+    STRCMP_EQUAL("\r\n> ", writtenToCharacterDevice().c_str());
+    CHECK_EQUAL(0U, mUnderTest->GetDroppedOutputByteCount());
+}
+
+TEST(EmbeddedCliServiceTests, refused_output_is_retried_upon_the_next_event_without_a_write_ready_callback)
+{
+    using namespace cms::test;
+    delete mMockCharacterDevice;
+    mMockCharacterDevice = new cms::mocks::MockCharacterDevice(true, false, true, false);
+    startServiceToActive();
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    mMockCharacterDevice->SetWriteSpace(0);
+    mMockCharacterDevice->InjectCharacterSequence("\n");
+    qf_ctrl::ProcessEvents();
+    CHECK_TRUE(writtenToCharacterDevice().empty());
+
+    mMockCharacterDevice->SetWriteSpace(SIZE_MAX);
+    mMockCharacterDevice->InjectCharacterSequence("\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+    STRCMP_EQUAL("\r\n> \r\n> ", writtenToCharacterDevice().c_str());
+}
+
+TEST(EmbeddedCliServiceTests, refused_output_is_retried_after_a_while_without_a_write_ready_callback)
+{
+    using namespace cms::test;
+    delete mMockCharacterDevice;
+    mMockCharacterDevice = new cms::mocks::MockCharacterDevice(true, false, true, false);
+    startServiceToActive();
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    mMockCharacterDevice->SetWriteSpace(0);
+    mMockCharacterDevice->InjectCharacterSequence("\n");
+    qf_ctrl::ProcessEvents();
+    CHECK_TRUE(writtenToCharacterDevice().empty());
+
+    //the device has room again, without saying so, and nothing else happens
+    mMockCharacterDevice->SetWriteSpace(SIZE_MAX);
+    qf_ctrl::MoveTimeForward(std::chrono::milliseconds(100));
+    mock().checkExpectations();
+    STRCMP_EQUAL("\r\n> ", writtenToCharacterDevice().c_str());
+}
+
+TEST(EmbeddedCliServiceTests, refused_output_is_written_when_the_write_ready_event_cannot_be_posted)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    mMockCharacterDevice->SetWriteSpace(0);
+    mMockCharacterDevice->InjectCharacterSequence("\n");
+    qf_ctrl::ProcessEvents();
+
+    //fill the AO's queue, leaving no room above the write ready event's margin
+    for (size_t i = 0; i < testQueueStorage.size(); ++i)
+    {
+        mUnderTest->BeginCliAsync(mMockCharacterDevice);
+    }
+    mMockCharacterDevice->SignalWriteReady();
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+    STRCMP_EQUAL("\r\n> ", writtenToCharacterDevice().c_str());
+}
+
+TEST(EmbeddedCliServiceTests, input_is_held_back_rather_than_dropping_output_while_the_device_is_blocked)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    //far more output than the transmit ring holds
+    const size_t lines = CMS_EMBEDDED_CLI_TX_RING_SIZE / 4;
+    std::string input(lines, '\n');
+    mMockCharacterDevice->SetWriteSpace(0);
+    mMockCharacterDevice->InjectCharacterSequence(input.c_str());
+    qf_ctrl::ProcessEvents();
+
+    mMockCharacterDevice->SignalWriteReady();
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    CHECK_EQUAL(lines, countOccurrences(writtenToCharacterDevice(), "\r\n> "));
+    CHECK_EQUAL(0U, mUnderTest->GetDroppedOutputByteCount());
+    CHECK_EQUAL(0U, mUnderTest->GetDroppedByteCount());
+}
+
+static constexpr int DUMP_LINE_COUNT = 40;
+
+static void onDumpCmd(EmbeddedCli* cli, char* args, void* context)
+{
+    (void)args;
+    (void)context;
+    for (int i = 0; i < DUMP_LINE_COUNT; ++i)
+    {
+        std::string line = "dump line " + std::to_string(i);
+        embeddedCliPrint(cli, line.c_str());
+    }
+}
+
+TEST(EmbeddedCliServiceTests, keystroke_echo_is_written_ahead_of_pending_command_output)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mUnderTest->AddCliBindingAsync({"dump", "Prints many lines", false, nullptr, onDumpCmd});
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    mMockCharacterDevice->SetWriteSpace(0);
+    mMockCharacterDevice->InjectCharacterSequence("dump\n");
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->InjectCharacterSequence("x");
+    qf_ctrl::ProcessEvents();
+
+    mMockCharacterDevice->SignalWriteReady();
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    std::string output = writtenToCharacterDevice();
+    for (int i = 0; i < DUMP_LINE_COUNT; ++i)
+    {
+        std::string line = "dump line " + std::to_string(i) + "\r\n";
+        CHECK_TRUE(output.find(line) != std::string::npos);
+    }
+    size_t echo = output.find("> x");
+    CHECK_TRUE(echo != std::string::npos);
+    CHECK_TRUE(echo < output.find("dump line " + std::to_string(DUMP_LINE_COUNT - 1)));
+    CHECK_EQUAL(0U, mUnderTest->GetDroppedOutputByteCount());
+}
+
+//command output as written by the binding, with its own line breaks
+static std::string reportOutput;
+
+static void onReportCmd(EmbeddedCli* cli, char* args, void* context)
+{
+    (void)args;
+    (void)context;
+    for (char c : reportOutput)
+    {
+        cli->writeChar(cli, c);
+    }
+}
+
+static std::string makeReport(size_t lines)
+{
+    std::string report;
+    for (size_t i = 0; i < lines; ++i)
+    {
+        report += "report line " + std::to_string(i) + ": " + std::string(24, 'a' + (i % 26)) + "\r\n";
+    }
+    //a line longer than the bulk output share, and a final line without a line break
+    report += std::string(300, '#') + "\r\n";
+    report += "done";
+    return report;
+}
+
+//the output as shown, without the line being edited, which is
+//cleared before output printed above it and drawn again after it
+static std::string withoutRedraws(std::string output)
+{
+    const std::string redraw = "> \r\x1B[K";
+    size_t pos;
+    while ((pos = output.find(redraw)) != std::string::npos)
+    {
+        output.erase(pos, redraw.size());
+    }
+    return output;
+}
+
+TEST(EmbeddedCliServiceTests, large_command_output_is_written_unchanged_with_default_settings)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mUnderTest->AddCliBindingAsync({"report", "Prints a long report", false, nullptr, onReportCmd});
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    //more than the transmit and bulk rings together hold
+    reportOutput = makeReport(60);
+    CHECK_TRUE(reportOutput.size() > CMS_EMBEDDED_CLI_TX_RING_SIZE + CMS_EMBEDDED_CLI_BULK_RING_SIZE);
+
+    mMockCharacterDevice->InjectCharacterSequence("report\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    std::string output = withoutRedraws(writtenToCharacterDevice());
+    STRCMP_EQUAL((reportOutput + "> ").c_str(), output.substr(output.find("\r\n") + 2).c_str());
+    CHECK_EQUAL(0U, mUnderTest->GetDroppedOutputByteCount());
+}
+
+TEST(EmbeddedCliServiceTests, command_output_waiting_for_a_slow_device_is_written_as_the_device_is_ready)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mUnderTest->AddCliBindingAsync({"report", "Prints a long report", false, nullptr, onReportCmd});
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    //as much as the transmit and bulk rings hold, while the device is busy
+    reportOutput = makeReport(20);
+    CHECK_TRUE(reportOutput.size() < CMS_EMBEDDED_CLI_TX_RING_SIZE / 4 + CMS_EMBEDDED_CLI_BULK_RING_SIZE);
+
+    mMockCharacterDevice->SetWriteSpace(0);
+    mMockCharacterDevice->InjectCharacterSequence("report\n");
+    qf_ctrl::ProcessEvents();
+
+    //a slow device, accepting a few bytes at a time
+    for (int i = 0; (i < 1000) && (mMockCharacterDevice->GetWrittenBytes().size() < reportOutput.size()); ++i)
+    {
+        mMockCharacterDevice->SignalWriteReady(16);
+        qf_ctrl::ProcessEvents();
+    }
+    mMockCharacterDevice->SignalWriteReady();
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    std::string output = withoutRedraws(writtenToCharacterDevice());
+    STRCMP_EQUAL((reportOutput + "> ").c_str(), output.substr(output.find("\r\n") + 2).c_str());
+    CHECK_EQUAL(0U, mUnderTest->GetDroppedOutputByteCount());
+}
+
+TEST(EmbeddedCliServiceTests, command_output_beyond_the_rings_waits_for_the_device_rather_than_being_dropped)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mUnderTest->AddCliBindingAsync({"report", "Prints a long report", false, nullptr, onReportCmd});
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    reportOutput = makeReport(60);
+    CHECK_TRUE(reportOutput.size() > CMS_EMBEDDED_CLI_TX_RING_SIZE + CMS_EMBEDDED_CLI_BULK_RING_SIZE);
+
+    //a device with a small FIFO, accepting a few bytes per write
+    mMockCharacterDevice->SetWriteLimit(16);
+    mMockCharacterDevice->InjectCharacterSequence("report\n");
+    qf_ctrl::ProcessEvents();
+    CHECK_EQUAL(0U, mUnderTest->GetDroppedOutputByteCount());
+
+    //the rest is retried after a while, as the device never says it is ready
+    qf_ctrl::MoveTimeForward(std::chrono::seconds(2));
+    mock().checkExpectations();
+
+    std::string output = withoutRedraws(writtenToCharacterDevice());
+    STRCMP_EQUAL((reportOutput + "> ").c_str(), output.substr(output.find("\r\n") + 2).c_str());
+    CHECK_EQUAL(0U, mUnderTest->GetDroppedOutputByteCount());
+}
+
+TEST(EmbeddedCliServiceTests, command_output_is_dropped_and_counted_once_the_device_stops_writing)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mUnderTest->AddCliBindingAsync({"report", "Prints a long report", false, nullptr, onReportCmd});
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    reportOutput = makeReport(60);
+    mMockCharacterDevice->SetWriteSpace(0);
+    mMockCharacterDevice->InjectCharacterSequence("report\n");
+    qf_ctrl::ProcessEvents();
+    CHECK_TRUE(mUnderTest->GetDroppedOutputByteCount() > 0);
+
+    //and the CLI carries on once the device writes again
+    mMockCharacterDevice->SignalWriteReady();
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->ClearWrittenBytes();
+    mMockCharacterDevice->InjectCharacterSequence("\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+    STRCMP_EQUAL("\r\n> ", writtenToCharacterDevice().c_str());
+}
+
+TEST(EmbeddedCliServiceTests, history_navigation_only_redraws_the_changed_part_of_the_line)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->InjectCharacterSequence("get-value\n");
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->InjectCharacterSequence("get-all\n");
+    qf_ctrl::ProcessEvents();
+
+    mMockCharacterDevice->InjectCharacterSequence("\x1B[A");
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    //"get-all" to "get-value", the common "get-" is not written again
+    mMockCharacterDevice->InjectCharacterSequence("\x1B[A");
+    qf_ctrl::ProcessEvents();
+    STRCMP_EQUAL("\x1B[3Dvalue", writtenToCharacterDevice().c_str());
+
+    //and back, the rest of the longer command is erased
+    mMockCharacterDevice->ClearWrittenBytes();
+    mMockCharacterDevice->InjectCharacterSequence("\x1B[B");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+    STRCMP_EQUAL("\x1B[5Dall\x1B[K", writtenToCharacterDevice().c_str());
+}
+
+TEST(EmbeddedCliServiceTests, bytes_per_keystroke_are_reported_for_the_standard_profile)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    std::string output = typeEditingKeystrokes();
+    mock().checkExpectations();
+    reportBytesPerKeystroke("standard", output);
+    CHECK_TRUE(output.find("\x1B[s") != std::string::npos);
+}
+
+TEST(EmbeddedCliServiceTests, bytes_per_keystroke_are_reported_for_the_low_bandwidth_profile)
+{
+    using namespace cms::test;
+    startServiceToActive(nullptr, EmbeddedCLI::Service::OverloadPolicy::MARK_LINE_CORRUPT,
+                         EmbeddedCLI::Service::RenderProfile::LOW_BANDWIDTH);
+    std::string output = typeEditingKeystrokes();
+    mock().checkExpectations();
+    reportBytesPerKeystroke("low bandwidth", output);
+
+    //no live autocompletion, so the cursor is never saved or restored
+    CHECK_EQUAL(0, countOccurrences(output, "\x1B[s"));
+    CHECK_EQUAL(0, countOccurrences(output, "\x1B[u"));
+    //cursor left and right are a single byte each
+    CHECK_EQUAL(0, countOccurrences(output, "\x1B[D"));
+    CHECK_EQUAL(0, countOccurrences(output, "\x1B[C"));
+    //tab completion still works without live autocompletion
+    CHECK_TRUE(output.find("temp ") != std::string::npos);
+}
+
+TEST(EmbeddedCliServiceTests, slow_links_select_the_low_bandwidth_profile)
+{
+    using Service = EmbeddedCLI::Service;
+    CHECK_TRUE(Service::ProfileForBaud(9600) == Service::RenderProfile::LOW_BANDWIDTH);
+    CHECK_TRUE(Service::ProfileForBaud(CMS_EMBEDDED_CLI_LOW_BANDWIDTH_BAUD) == Service::RenderProfile::LOW_BANDWIDTH);
+    CHECK_TRUE(Service::ProfileForBaud(115200) == Service::RenderProfile::STANDARD);
+}
+
+TEST(EmbeddedCliServiceTests, print_async_writes_above_the_line_being_edited)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->InjectCharacterSequence("hel");
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    mUnderTest->PrintAsync("progress 50%");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    //the line is cleared, the text printed, then the line is restored
+    std::string output = writtenToCharacterDevice();
+    CHECK_EQUAL(0, output.find("\r\x1B[Kprogress 50%\r\n> hel"));
+}
+
+TEST(EmbeddedCliServiceTests, print_async_copies_text_of_any_size_class)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    std::string small = "short";
+    std::string medium(40, 'm');
+    std::string large(100, 'L');
+    mUnderTest->PrintAsync(small.c_str());
+    mUnderTest->PrintAsync(medium.c_str());
+    mUnderTest->PrintAsync(large.c_str());
+
+    //the caller's text may change as soon as it has been posted
+    small[0] = '?';
+    medium[0] = '?';
+    large[0] = '?';
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    std::string output = writtenToCharacterDevice();
+    CHECK_TRUE(output.find("short\r\n") != std::string::npos);
+    CHECK_TRUE(output.find(std::string(40, 'm') + "\r\n") != std::string::npos);
+    CHECK_TRUE(output.find(std::string(100, 'L') + "\r\n") != std::string::npos);
+}
+
+TEST(EmbeddedCliServiceTests, print_async_truncates_text_longer_than_the_largest_event)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    std::string text(CMS_EMBEDDED_CLI_PRINT_LARGE_EVENT_SIZE, 'x');
+    mUnderTest->PrintAsync(text.c_str());
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    std::string output = writtenToCharacterDevice();
+    CHECK_TRUE(output.find("x\r\n") != std::string::npos);
+    CHECK_TRUE(countOccurrences(output, "x") < text.size());
+}
+
+TEST(EmbeddedCliServiceTests, print_static_async_prints_text_without_copying_it)
+{
+    using namespace cms::test;
+    static const char text[] = "a long and constant message which is not copied into an event, "
+                               "and so is never truncated regardless of its length, which is "
+                               "longer than the largest event used to copy text";
+    static_assert(sizeof(text) > CMS_EMBEDDED_CLI_PRINT_LARGE_EVENT_SIZE, "text must not fit an event");
+    startServiceToActive();
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    mUnderTest->PrintStaticAsync(text);
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    CHECK_TRUE(writtenToCharacterDevice().find(std::string(text) + "\r\n") != std::string::npos);
+}
+
+TEST(EmbeddedCliServiceTests, print_async_drops_and_counts_text_rather_than_asserting_when_flooded)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    //a burst of progress reports, far more than the AO's queue holds
+    const size_t reports = 3 * testQueueStorage.size();
+    size_t printed = 0;
+    for (size_t i = 0; i < reports; ++i)
+    {
+        std::string text = "progress " + std::to_string(i);
+        bool posted = ((i % 2) == 0) ? mUnderTest->PrintAsync(text.c_str()) : mUnderTest->PrintStaticAsync("progress");
+        printed += posted ? 1 : 0;
+    }
+    CHECK_TRUE(printed > 0);
+    CHECK_TRUE(printed < reports);
+    CHECK_EQUAL(reports - printed, mUnderTest->GetDroppedPrintCount());
+
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+    CHECK_EQUAL(printed, countOccurrences(writtenToCharacterDevice(), "progress"));
+
+    //printing resumes once the AO has caught up
+    CHECK_TRUE(mUnderTest->PrintAsync("done"));
+    qf_ctrl::ProcessEvents();
+    CHECK_TRUE(writtenToCharacterDevice().find("done\r\n") != std::string::npos);
+    CHECK_EQUAL(reports - printed, mUnderTest->GetDroppedPrintCount());
+}
+
+TEST(EmbeddedCliServiceTests, print_async_text_is_discarded_while_inactive)
+{
+    using namespace cms::test;
+    startService();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    mUnderTest->PrintAsync("nobody is listening");
+    mUnderTest->PrintStaticAsync("nor here");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    CHECK_TRUE(writtenToCharacterDevice().empty());
+}
+
+static void onFormatCmd(EmbeddedCli* cli, char* args, void* context)
+{
+    (void)args;
+    (void)context;
+    using EmbeddedCLI::PrintFormatted;
+    PrintFormatted(cli, "id=%d hex=%08x name=%s c=%c neg=%x pct=%%", -42, 0xBEEFu, "abc", 'Z', int8_t(-1));
+    PrintFormatted(cli, "[%5d][%-5d][%05d][%3s][%-3s]", 42, 42, -42, "a", "b");
+    PrintFormatted(cli, "%llu %lld %u", UINT64_MAX, INT64_MIN, uint8_t(255));
+    PrintFormatted(cli, "%d and %d", 1);
+    PrintFormatted(cli, "no arguments");
+}
+
+//types which PrintFormatted() cannot print must not compile, rather
+//than being converted to one it can, e.g. a double to a char.
+namespace {
+enum class FormatTestEnum { VALUE };
+enum FormatTestPlainEnum { PLAIN_VALUE };
+} //namespace
+
+static_assert(std::is_convertible<char, EmbeddedCLI::FormatArg>::value, "chars are printed");
+static_assert(std::is_convertible<uint8_t, EmbeddedCLI::FormatArg>::value, "integers are printed");
+static_assert(std::is_convertible<const char(&)[4], EmbeddedCLI::FormatArg>::value, "strings are printed");
+static_assert(!std::is_convertible<double, EmbeddedCLI::FormatArg>::value, "doubles must not compile");
+static_assert(!std::is_convertible<float, EmbeddedCLI::FormatArg>::value, "floats must not compile");
+static_assert(!std::is_convertible<long double, EmbeddedCLI::FormatArg>::value, "long doubles must not compile");
+static_assert(!std::is_convertible<FormatTestEnum, EmbeddedCLI::FormatArg>::value, "enums must not compile");
+static_assert(!std::is_convertible<FormatTestPlainEnum, EmbeddedCLI::FormatArg>::value, "enums must not compile");
+
+TEST(EmbeddedCliServiceTests, formatted_print_streams_type_safe_output)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mUnderTest->AddCliBindingAsync({"fmt", "", false, nullptr, onFormatCmd});
+    qf_ctrl::ProcessEvents();
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    mMockCharacterDevice->InjectCharacterSequence("fmt\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    std::string output = writtenToCharacterDevice();
+    CHECK_TRUE(output.find("\r\nid=-42 hex=0000beef name=abc c=Z neg=ff pct=%\r\n") != std::string::npos);
+    CHECK_TRUE(output.find("\r\n[   42][42   ][-0042][  a][b  ]\r\n") != std::string::npos);
+    CHECK_TRUE(output.find("\r\n18446744073709551615 -9223372036854775808 255\r\n") != std::string::npos);
+    CHECK_TRUE(output.find("1 and %d\r\n") != std::string::npos);
+    CHECK_TRUE(output.find("no arguments\r\n") != std::string::npos);
+}
+
+TEST(EmbeddedCliServiceTests, number_formatters_match_printf_output)
+{
+    using namespace EmbeddedCLI;
+    char text[FIXED_POINT_BUFFER_SIZE];
+
+    CHECK_EQUAL(1, FormatDecimal(0, text));
+    STRCMP_EQUAL("0", text);
+    CHECK_EQUAL(10, FormatDecimal(UINT32_MAX, text));
+    STRCMP_EQUAL("4294967295", text);
+    CHECK_EQUAL(20, FormatDecimal(UINT64_MAX, text));
+    STRCMP_EQUAL("18446744073709551615", text);
+    FormatDecimal(10000000000000000001u, text);
+    STRCMP_EQUAL("10000000000000000001", text);
+    CHECK_EQUAL(20, FormatSignedDecimal(INT64_MIN, text));
+    STRCMP_EQUAL("-9223372036854775808", text);
+    FormatSignedDecimal(-7, text);
+    STRCMP_EQUAL("-7", text);
+
+    CHECK_EQUAL(8, FormatHex(0x1F, 8, text));
+    STRCMP_EQUAL("0000001f", text);
+    FormatHex(0xDEADBEEFu, 0, text, true);
+    STRCMP_EQUAL("DEADBEEF", text);
+    FormatHex(0, 0, text);
+    STRCMP_EQUAL("0", text);
+    CHECK_EQUAL(16, FormatHex(0x1234, 40, text));
+    STRCMP_EQUAL("0000000000001234", text);
+
+    CHECK_EQUAL(6, FormatFixedPoint(-1250, 3, text));
+    STRCMP_EQUAL("-1.250", text);
+    FormatFixedPoint(5, 3, text);
+    STRCMP_EQUAL("0.005", text);
+    FormatFixedPoint(-50, 2, text);
+    STRCMP_EQUAL("-0.50", text);
+    FormatFixedPoint(42, 0, text);
+    STRCMP_EQUAL("42", text);
+    CHECK_EQUAL(FIXED_POINT_BUFFER_SIZE - 1, FormatFixedPoint(INT64_MIN, 200, text));
+    STRCMP_EQUAL("-0.9223372036854775808", text);
+}
+
+//a few hundred bytes of memory, ending with some text
+static std::array<char, 256 + 20> hexDumpMemory()
+{
+    std::array<char, 256 + 20> memory;
+    for (size_t i = 0; i < 256; ++i)
+    {
+        memory[i] = static_cast<char>(i);
+    }
+    memcpy(&memory[256], "Hello, hexdump!\n\x01\x7F\xFF", 20);
+    return memory;
+}
+
+static void onHexDumpCmd(EmbeddedCli* cli, char* args, void* context)
+{
+    (void)args;
+    (void)context;
+    static const auto memory = hexDumpMemory();
+    EmbeddedCLI::PrintHexDump(cli, memory.data(), memory.size(), 0x20000000u);
+}
+
+TEST(EmbeddedCliServiceTests, hexdump_streams_lines_to_the_cli_output)
+{
+    using namespace cms::test;
+    startServiceToActive();
+    mUnderTest->AddCliBindingAsync({"dump", "", false, nullptr, onHexDumpCmd});
+    qf_ctrl::ProcessEvents();
+    mock("CharacterDevice").ignoreOtherCalls();
+    mMockCharacterDevice->ClearWrittenBytes();
+
+    mMockCharacterDevice->InjectCharacterSequence("dump\n");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    //the same dump, as formatted by printf
+    const auto memory = hexDumpMemory();
+    std::string expected;
+    for (size_t offset = 0; offset < memory.size(); offset += 16)
+    {
+        char text[16];
+        snprintf(text, sizeof(text), "%08zx", 0x20000000u + offset);
+        expected += text;
+        std::string ascii;
+        for (size_t i = offset; i < offset + 16; ++i)
+        {
+            expected += ((i % 8) == 0) ? " " : "";
+            if (i < memory.size())
+            {
+                auto byte = static_cast<uint8_t>(memory[i]);
+                snprintf(text, sizeof(text), " %02x", byte);
+                expected += text;
+                ascii += ((byte >= 0x20) && (byte < 0x7F)) ? static_cast<char>(byte) : '.';
+            }
+            else
+            {
+                expected += "   ";
+            }
+        }
+        expected += "  |" + ascii + "|\r\n";
+    }
+
+    std::string output = withoutRedraws(writtenToCharacterDevice());
+    STRCMP_EQUAL((expected + "> ").c_str(), output.substr(output.find("\r\n") + 2).c_str());
+    CHECK_TRUE(output.find("\r\n20000100  48 65 6c 6c 6f 2c 20 68  65 78 64 75 6d 70 21 0a  |Hello, hexdump!.|\r\n"
+                           "20000110  01 7f ff 00                                       |....|\r\n") !=
+               std::string::npos);
+    CHECK_EQUAL(0U, mUnderTest->GetDroppedOutputByteCount());
+}
+
+TEST(EmbeddedCliServiceTests, help_listing_is_produced_only_as_the_device_accepts_it)
+{
+    using namespace cms::test;
+    static constexpr int BINDING_COUNT = 40;
+    startService(nullptr, 0, nullptr, BINDING_COUNT + 1);
+    mock().ignoreOtherCalls();
+    mUnderTest->BeginCliAsync(mMockCharacterDevice);
+    qf_ctrl::ProcessEvents();
+
+    //far more output than the transmit and bulk rings hold
+    static std::array<std::string, BINDING_COUNT> names;
+    for (int i = 0; i < BINDING_COUNT; ++i)
+    {
+        names[i] = "command" + std::to_string(100 + i);
+        mUnderTest->AddCliBindingAsync({names[i].c_str(), "Help text which makes each entry of the listing long",
+                                        false, nullptr, onTestCmd});
+        qf_ctrl::ProcessEvents();
+    }
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    mMockCharacterDevice->SetWriteSpace(0);
+    mMockCharacterDevice->InjectCharacterSequence("help\n");
+    qf_ctrl::ProcessEvents();
+    //typed while the listing is produced, so it waits
+    mMockCharacterDevice->InjectCharacterSequence("x");
+    qf_ctrl::ProcessEvents();
+
+    mMockCharacterDevice->SignalWriteReady();
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+
+    std::string output = writtenToCharacterDevice();
+    for (const auto& name : names)
+    {
+        CHECK_TRUE(output.find(" * " + name + "\r\n") != std::string::npos);
+    }
+    CHECK_TRUE(output.find(" * help\r\n") != std::string::npos);
+    CHECK_EQUAL(0U, mUnderTest->GetDroppedOutputByteCount());
+    CHECK_EQUAL(1U, countOccurrences(output, "\r\n> "));
+    CHECK_TRUE(output.size() >= 3);
+    STRCMP_EQUAL("> x", output.substr(output.size() - 3).c_str());
+}
+
+TEST(EmbeddedCliServiceTests, help_listing_is_completed_by_retries_without_a_write_ready_callback)
+{
+    using namespace cms::test;
+    static constexpr int BINDING_COUNT = 40;
+    delete mMockCharacterDevice;
+    mMockCharacterDevice = new cms::mocks::MockCharacterDevice(true, false, true, false);
+    startService(nullptr, 0, nullptr, BINDING_COUNT + 1);
+    mock().ignoreOtherCalls();
+    mUnderTest->BeginCliAsync(mMockCharacterDevice);
+    qf_ctrl::ProcessEvents();
+
+    static std::array<std::string, BINDING_COUNT> names;
+    for (int i = 0; i < BINDING_COUNT; ++i)
+    {
+        names[i] = "command" + std::to_string(100 + i);
+        mUnderTest->AddCliBindingAsync({names[i].c_str(), "Help text which makes each entry of the listing long",
+                                        false, nullptr, onTestCmd});
+        qf_ctrl::ProcessEvents();
+    }
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    //a device which accepts a few bytes at a time, and never says when it has room
+    mMockCharacterDevice->SetWriteLimit(16);
+    mMockCharacterDevice->InjectCharacterSequence("help\n");
+    qf_ctrl::ProcessEvents();
+    qf_ctrl::MoveTimeForward(std::chrono::seconds(10));
+    mock().checkExpectations();
+
+    std::string output = writtenToCharacterDevice();
+    for (const auto& name : names)
+    {
+        CHECK_TRUE(output.find(" * " + name + "\r\n") != std::string::npos);
+    }
+    CHECK_TRUE(output.size() >= 4);
+    STRCMP_EQUAL("\r\n> ", output.substr(output.size() - 4).c_str());
+    CHECK_EQUAL(0U, mUnderTest->GetDroppedOutputByteCount());
+}
+
+//produces its output a few lines at a time
+static constexpr int PAGED_LINES_PER_CALL = 3;
+static int pagedCalls;
+static int pagedLine;
+
+static bool producePagedLines(EmbeddedCli* cli, void* context)
+{
+    (void)context;
+    for (int i = 0; i < PAGED_LINES_PER_CALL; ++i)
+    {
+        ++pagedLine;
+        std::string line = "paged line " + std::to_string(pagedLine) + "\r\n";
+        for (char c : line)
+        {
+            cli->writeChar(cli, c);
+        }
+    }
+    return --pagedCalls > 0;
+}
+
+static void onPagedCmd(EmbeddedCli* cli, char* args, void* context)
+{
+    (void)args;
+    (void)context;
+    pagedLine = 0;
+    embeddedCliSetOutputProducer(cli, producePagedLines, nullptr);
+}
+
+TEST(EmbeddedCliServiceTests, pager_stops_a_producer_writing_several_lines_at_the_end_of_the_page)
+{
+    using namespace cms::test;
+    startService();
+    mUnderTest->SetPagerLines(4);
+    mock().ignoreOtherCalls();
+    mUnderTest->BeginCliAsync(mMockCharacterDevice);
+    qf_ctrl::ProcessEvents();
+    mUnderTest->AddCliBindingAsync({"paged", "Prints many lines", false, nullptr, onPagedCmd});
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    //nine lines, the last of which follow the final producer call
+    pagedCalls = 3;
+    mMockCharacterDevice->InjectCharacterSequence("paged\n");
+    qf_ctrl::ProcessEvents();
+    std::string output = writtenToCharacterDevice();
+    CHECK_TRUE(output.find("paged line 4\r\n--More--") != std::string::npos);
+    CHECK_TRUE(output.find("paged line 5") == std::string::npos);
+
+    mMockCharacterDevice->ClearWrittenBytes();
+    mMockCharacterDevice->InjectCharacterSequence(" ");
+    qf_ctrl::ProcessEvents();
+    output = writtenToCharacterDevice();
+    STRCMP_EQUAL("\r\x1B[Kpaged line 5\r\npaged line 6\r\npaged line 7\r\npaged line 8\r\n> \r\x1B[K--More--",
+                 output.c_str());
+
+    mMockCharacterDevice->ClearWrittenBytes();
+    mMockCharacterDevice->InjectCharacterSequence(" ");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+    output = writtenToCharacterDevice();
+    CHECK_TRUE(output.find("paged line 9\r\n> ") != std::string::npos);
+    CHECK_TRUE(output.find("--More--") == std::string::npos);
+    STRCMP_EQUAL("> ", output.substr(output.size() - 2).c_str());
+}
+
+TEST(EmbeddedCliServiceTests, pager_pauses_help_listing_until_a_key_is_pressed)
+{
+    using namespace cms::test;
+    startService();
+    mUnderTest->SetPagerLines(4);
+    mock().ignoreOtherCalls();
+    mUnderTest->BeginCliAsync(mMockCharacterDevice);
+    qf_ctrl::ProcessEvents();
+
+    static const char* names[] = {"alpha", "bravo", "charlie", "delta"};
+    for (const char* name : names)
+    {
+        mUnderTest->AddCliBindingAsync({name, "Help", false, nullptr, onTestCmd});
+    }
+    qf_ctrl::ProcessEvents();
+    mMockCharacterDevice->ClearWrittenBytes();
+    mock("CharacterDevice").ignoreOtherCalls();
+
+    //two entries of two lines each fill a page
+    mMockCharacterDevice->InjectCharacterSequence("help\n");
+    qf_ctrl::ProcessEvents();
+    std::string output = writtenToCharacterDevice();
+    CHECK_TRUE(output.find(" * bravo\r\n\tHelp\r\n--More--") != std::string::npos);
+    CHECK_TRUE(output.find("charlie") == std::string::npos);
+
+    mMockCharacterDevice->ClearWrittenBytes();
+    mMockCharacterDevice->InjectCharacterSequence(" ");
+    qf_ctrl::ProcessEvents();
+    output = writtenToCharacterDevice();
+    STRCMP_EQUAL("\r\x1B[K * charlie\r\n\tHelp\r\n * delta\r\n\tHelp\r\n--More--", output.c_str());
+
+    //ends the listing before the help binding itself
+    mMockCharacterDevice->ClearWrittenBytes();
+    mMockCharacterDevice->InjectCharacterSequence("q");
+    qf_ctrl::ProcessEvents();
+    mock().checkExpectations();
+    output = writtenToCharacterDevice();
+    STRCMP_EQUAL("\r\x1B[K> ", output.c_str());
+}
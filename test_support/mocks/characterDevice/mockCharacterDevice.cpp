@@ -9,25 +9,105 @@ namespace mocks {
 
 bool MockCharacterDevice::WriteAsync(uint8_t byte)
 {
+    if (mWriteSpace == 0)
+    {
+        return false;
+    }
+    if (mWriteSpace != SIZE_MAX)
+    {
+        --mWriteSpace;
+    }
+
+    mWrittenBytes.push_back(byte);
     mock(MOCK_NAME).actualCall("WriteAsync").withParameter("byte", byte);
     return static_cast<bool>(mock(MOCK_NAME).returnIntValueOrDefault(true)); //use IntValue due to bug in CppUTest 3.8 bool handling.
 }
 
+size_t MockCharacterDevice::WriteAsync(const uint8_t* bytes, size_t length)
+{
+    if (!mBulkWriteSupported)
+    {
+        return CharacterDevice::WriteAsync(bytes, length);
+    }
+
+    //each byte is still reported to the mock, so expectations
+    //need not care how the output was grouped.
+    ++mBulkWriteCount;
+    length = (mWriteLimit < length) ? mWriteLimit : length;
+    size_t written = 0;
+    while ((written < length) && WriteAsync(bytes[written]))
+    {
+        ++written;
+    }
+    return written;
+}
+
 void MockCharacterDevice::RegisterNewByteCallback(NewByteCallback callback, void* userData)
 {
     mCallback = callback;
     mUserData = userData;
 }
 
+bool MockCharacterDevice::RegisterNewBytesCallback(NewBytesCallback callback, void* userData)
+{
+    if (!mBulkReceiveSupported)
+    {
+        return false;
+    }
+
+    mBytesCallback = callback;
+    mUserData = userData;
+    return true;
+}
+
+bool MockCharacterDevice::SetReceiveFlowControl(FlowControl state)
+{
+    if (!mFlowControlSupported)
+    {
+        return false;
+    }
+
+    mock(MOCK_NAME).actualCall("SetReceiveFlowControl").withParameter("stop", state == FlowControl::STOP);
+    return true;
+}
+
+bool MockCharacterDevice::RegisterWriteReadyCallback(WriteReadyCallback callback, void* userData)
+{
+    if (!mWriteReadySupported)
+    {
+        return false;
+    }
+
+    mWriteReadyCallback = callback;
+    mWriteReadyUserData = userData;
+    return true;
+}
+
+void MockCharacterDevice::SignalWriteReady(size_t bytes)
+{
+    mWriteSpace = bytes;
+    if (mWriteReadyCallback != nullptr)
+    {
+        mWriteReadyCallback(mWriteReadyUserData);
+    }
+}
+
 void MockCharacterDevice::InjectCharacterSequence(const char* inject)
 {
+    size_t injectLength = strlen(inject);
+
+    if (mBytesCallback != nullptr)
+    {
+        mBytesCallback(mUserData, reinterpret_cast<const uint8_t*>(inject), injectLength);
+        return;
+    }
+
     if (mCallback == nullptr)
     {
         //noting to do, just return
         return;
     }
 
-    size_t injectLength = strlen(inject);
     for (size_t i = 0; i < injectLength; ++i)
     {
         mCallback(mUserData, static_cast<uint8_t>(inject[i]));
@@ -3,6 +3,8 @@
 #ifndef EMBEDDED_CLI_FOR_QPCPP_MOCKCHARACTERDEVICE_HPP
 #define EMBEDDED_CLI_FOR_QPCPP_MOCKCHARACTERDEVICE_HPP
 
+#include <vector>
+#include <cstdint>
 #include "characterDeviceInterface.hpp"
 
 namespace cms {
@@ -11,17 +13,60 @@ namespace mocks {
 class MockCharacterDevice : public cms::interfaces::CharacterDevice
 {
 public:
-    MockCharacterDevice() = default;
+    explicit MockCharacterDevice(bool bulkReceiveSupported = true, bool flowControlSupported = false,
+                                 bool bulkWriteSupported = true, bool writeReadySupported = true) :
+        mBulkReceiveSupported(bulkReceiveSupported),
+        mFlowControlSupported(flowControlSupported),
+        mBulkWriteSupported(bulkWriteSupported),
+        mWriteReadySupported(writeReadySupported)
+    {
+    }
     virtual ~MockCharacterDevice() = default;
 
     bool WriteAsync(uint8_t byte) override;
+    size_t WriteAsync(const uint8_t* bytes, size_t length) override;
     void RegisterNewByteCallback(NewByteCallback callback, void* userData) override;
+    bool RegisterNewBytesCallback(NewBytesCallback callback, void* userData) override;
+    bool SetReceiveFlowControl(FlowControl state) override;
+    bool RegisterWriteReadyCallback(WriteReadyCallback callback, void* userData) override;
 
     //unit test specific access
+    //delivers the whole sequence as a single burst if a bulk
+    //callback is registered, otherwise one byte at a time.
     void InjectCharacterSequence(const char * inject);
 
+    //every byte written, in order, since the last clear
+    const std::vector<uint8_t>& GetWrittenBytes() const { return mWrittenBytes; }
+    void ClearWrittenBytes() { mWrittenBytes.clear(); mBulkWriteCount = 0; }
+
+    //number of block writes since the last clear
+    size_t GetBulkWriteCount() const { return mBulkWriteCount; }
+
+    //limit how many more bytes are accepted, as if a TX FIFO were full.
+    //bytes beyond the limit are refused and not reported to the mock.
+    void SetWriteSpace(size_t bytes) { mWriteSpace = bytes; }
+
+    //limit how many bytes each block write accepts, as if a small
+    //TX FIFO drained between writes.
+    void SetWriteLimit(size_t bytes) { mWriteLimit = bytes; }
+
+    //frees up write space and executes the write ready callback, if
+    //registered, as a device's TX interrupt would.
+    void SignalWriteReady(size_t bytes = SIZE_MAX);
+
 private:
+    const bool mBulkReceiveSupported;
+    const bool mFlowControlSupported;
+    const bool mBulkWriteSupported;
+    const bool mWriteReadySupported;
+    std::vector<uint8_t> mWrittenBytes;
+    size_t mBulkWriteCount = 0;
+    size_t mWriteSpace = SIZE_MAX;
+    size_t mWriteLimit = SIZE_MAX;
+    WriteReadyCallback mWriteReadyCallback = nullptr;
+    void* mWriteReadyUserData = nullptr;
     NewByteCallback mCallback = nullptr;
+    NewBytesCallback mBytesCallback = nullptr;
     void* mUserData = nullptr;
 };
 